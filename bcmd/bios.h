@@ -14,11 +14,18 @@
 #ifndef BIOS_H
 #define BIOS_H
 
+/* From the BIOS runtime (see ../biosrt/README). */
+
 void __attribute__((fastcall)) clear (void);
-void __attribute__((fastcall)) print();
-void __attribute__((fastcall)) println();
-void __attribute__((fastcall)) readln(char *);
+void __attribute__((fastcall)) kwrite(const char *);
+int __attribute__((fastcall)) kread(char *, int);
+int __attribute__((fastcall)) strcmp(const char *s1, const char *s2);
+
+/* From bios.S. */
+
 void __attribute__((fastcall)) date();
+void __attribute__((fastcall)) bench(void);
+void __attribute__((fastcall)) halt(void); /* In rt0.S. */
 
 
 #endif
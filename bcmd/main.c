@@ -12,36 +12,43 @@
  */
 
 #include "bios.h"
-#include "opt.h"
 
 #define PROMPT "$ " /* Prompt sign.      */
 #define SIZE 20     /* Read buffer size. */
 
 char buffer[SIZE]; /* Read buffer.      */
 
+/* Built-in commands. Exit just halts, as returning from main() would. */
+
+#define COMMANDS 4
+
+struct command_t {
+    const char *name;
+    void __attribute__((fastcall)) (*function)(void);
+} commands[COMMANDS] = {{"clear", clear}, {"date", date}, {"bench", bench}, {"exit", halt}};
+
 int main()
 {
+    struct command_t *command;
+
     clear();
 
-    println("Boot Command 1.0");
+    kwrite("Boot Command 1.0\n");
 
     while (1) {
-        print(PROMPT);  /* Show prompt.               */
-        readln(buffer); /* Read use input.            */
+        kwrite(PROMPT);      /* Show prompt.               */
+        kread(buffer, SIZE); /* Read use input.            */
 
         if (buffer[0]) /* Execute built-in command.  */
         {
-            if (!strcmp(buffer, "clear"))
-                clear();
-
-            else if (!strcmp(buffer, "date"))
-                date();
-
-            else if (!strcmp(buffer, "exit"))
-                return 0;
-
-            else
-                println("Unkown command.");
+            for (command = commands; command < commands + COMMANDS; command++)
+                if (!strcmp(buffer, command->name)) {
+                    command->function();
+                    break;
+                }
+
+            if (command == commands + COMMANDS)
+                kwrite("Unkown command.\n");
         }
     }
 
@@ -0,0 +1,47 @@
+#
+#    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+#    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+#    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+#
+#    SPDX-License-Identifier: GPL-3.0-or-later
+#
+#  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+#  and contains modifications carried out by the following author(s):
+#  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+#  Tiago Oliva <tiago.oliva.costa@gmail.com>
+#
+
+# Rules to build the BIOS runtime (see README) into a program.
+#
+# The including Makefile sets BIOSRT to the variant it links (tiny or
+# fast), BIOSRT_ROUTINES to the routines it needs and, if they are called
+# from C, BIOSRT_GCC = 1; it may add more --defsym options to
+# BIOSRT_ASFLAGS. It then links $(BIOSRT_OBJS) and makes the program
+# depend on biosrt.variant too, which changes whenever BIOSRT does.
+#
+# The objects of each variant are kept apart, under biosrt-tiny/ and
+# biosrt-fast/.
+
+BIOSRT_DIR := $(dir $(lastword $(MAKEFILE_LIST)))
+
+ifeq (,$(filter tiny fast,$(BIOSRT)))
+$(error BIOSRT must be either tiny or fast)
+endif
+
+BIOSRT_OBJS = $(BIOSRT_ROUTINES:%=biosrt-$(BIOSRT)/%.o)
+
+BIOSRT_ASFLAGS = -I $(BIOSRT_DIR) $(if $(BIOSRT_GCC),--defsym BIOSRT_GCC=1)
+
+biosrt-tiny/%.o : $(BIOSRT_DIR)%.S $(BIOSRT_DIR)biosrt.inc
+	@mkdir -p $(@D)
+	as -32 $(BIOSRT_ASFLAGS) $< -o $@
+
+biosrt-fast/%.o : $(BIOSRT_DIR)%.S $(BIOSRT_DIR)biosrt.inc
+	@mkdir -p $(@D)
+	as -32 $(BIOSRT_ASFLAGS) --defsym BIOSRT_FAST=1 $< -o $@
+
+ifneq ($(BIOSRT),$(shell cat biosrt.variant 2>/dev/null))
+$(shell echo $(BIOSRT) > biosrt.variant)
+endif
+
+BIOSRT_CLEAN = biosrt-tiny biosrt-fast biosrt.variant
@@ -0,0 +1,5 @@
+boottime dump
+time list
+time exec hello.bin
+time sysloop
+quit
@@ -0,0 +1,75 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+
+/* Helpers shared by the benchmark programs (sysbench, conbench, readbench
+   and dirbench). Each times an operation with clock(), running it in
+   batches until at least BENCH_MS have passed, and prints the rate. In
+   real mode the clock advances in 55 ms steps, so a rate may be off by
+   about 5%; a longer BENCH_MS narrows that. */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "tydos.h"
+
+#define BENCH_MS 1000
+
+/* Run 'op' with 'arg' in batches of 'batch' calls for about BENCH_MS, or
+   until it fails (returns less than 0). Return the number of calls and
+   the time taken, in milliseconds, in 'ms'. */
+
+static unsigned int bench_run(int (*op)(void *), void *arg, unsigned int batch,
+                              unsigned int *ms)
+{
+    unsigned int start, calls = 0, i;
+
+    start = clock();
+    do {
+        for (i = 0; i < batch; i++)
+            if (op(arg) < 0)
+                break;
+        calls += i;
+    } while (i == batch && clock() - start < BENCH_MS);
+
+    *ms = clock() - start;
+    return calls;
+}
+
+/* Print 'n' in decimal. */
+
+static void put_uint(unsigned int n)
+{
+    char digits[11], *p = digits + sizeof(digits) - 1;
+
+    *p = '\0';
+    do {
+        *--p = '0' + n % 10;
+        n /= 10;
+    } while (n);
+    puts(p);
+}
+
+/* Print "<what>: <count per second> <unit>/s". */
+
+static void bench_report(const char *what, unsigned int count, unsigned int ms, const char *unit)
+{
+    puts(what);
+    puts(": ");
+    put_uint(ms ? count / ms * 1000 + count % ms * 1000 / ms : 0);
+    puts(" ");
+    puts(unit);
+    puts("/s\n");
+}
+
+#endif /* BENCH_H  */
@@ -14,12 +14,15 @@
 #ifndef BIOS1_H
 #define BIOS1_H
 
+/* The screen routines come from the BIOS runtime (see ../biosrt/README),
+   or from pmdrv.c in protected mode. */
+
 void __attribute__((fastcall)) clear (void);
 void __attribute__((fastcall)) kwrite(const char*);
 void __attribute__((fastcall)) kwriteln(const char*);
 /* void __attribute__((fastcall)) kread(char *); */
 void __attribute__((fastcall)) fatal(const char*);
 void __attribute__((fastcall)) load_kernel(void);
-void __attribute__((fastcall)) set_cursor(char, char);
+void __attribute__((fastcall)) set_cursor(char, char); /* pmdrv.c only. */
 
 #endif
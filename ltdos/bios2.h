@@ -14,8 +14,9 @@
 #ifndef BIOS2_H
 #define BIOS2_H
 
-int __attribute__((fastcall)) kread(char *);
+int __attribute__((fastcall)) kread(char *buffer, int size); /* BIOS runtime (or pmdrv.c). */
 void __attribute__((fastcall)) udelay(unsigned short);
-void __attribute__((fastcall)) exec();
+int __attribute__((fastcall)) exec(void *entry, void *stack);
+void __attribute__((fastcall)) exec_exit(int status);
 
 #endif  /* BIOS2_H  */
@@ -13,13 +13,20 @@
 
 #include "bios1.h"		/* Function load_kernel . */
 #include "kernel.h"		/* Function kmain.        */
+#ifdef TYDOS_PM
+#include "pm.h"			/* Function pm_start.     */
+#endif
 
 int boot()
 {
   
   load_kernel();		/* Load the kernel from disk image.  */
   
+#ifdef TYDOS_PM
+  pm_start();			/* Enter protected mode, then kmain. */
+#else
   kmain();		        /* Call the kernel's entry function. */
+#endif
   
   return 0;
 
@@ -0,0 +1,52 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+
+/* Measure console write throughput for a few string lengths. The writes
+   scroll the screen, so the rates are printed at the end. */
+
+#include "bench.h"
+
+#define LENGTHS 4
+
+static const unsigned int lengths[LENGTHS] = {1, 16, 64, 256};
+
+char text[256 + 1];
+
+static int write_text(void *arg)
+{
+    puts(arg);
+    return 0;
+}
+
+int main()
+{
+    unsigned int calls[LENGTHS], ms[LENGTHS];
+    int i;
+
+    for (i = 0; i < LENGTHS; i++) {
+        memset(text, 'a' + i, lengths[i]);
+        text[lengths[i]] = '\0';
+        calls[i] = bench_run(write_text, text, 10, &ms[i]);
+    }
+
+    puts("\n");
+    for (i = 0; i < LENGTHS; i++) {
+        puts("write ");
+        put_uint(lengths[i]);
+        bench_report(" bytes", calls[i], ms[i], "calls");
+        bench_report("  throughput", calls[i] * lengths[i], ms[i], "bytes");
+    }
+
+    return 0;
+}
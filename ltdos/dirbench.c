@@ -0,0 +1,56 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+
+/* Measure directory lookup latency: the rate of open() and close() of a
+   file (the command tail, or LOOKUP_FILE) and of failed opens of a file
+   that does not exist, which scan the whole directory. */
+
+#include "bench.h"
+
+#define LOOKUP_FILE "sonnet_130.txt"
+#define MISSING_FILE "no such file"
+
+static int lookup(void *arg)
+{
+    int fd = open(arg);
+
+    if (fd >= 0)
+        close(fd);
+    return fd;
+}
+
+static int lookup_missing(void *arg)
+{
+    open(arg);
+    return 0;
+}
+
+int main()
+{
+    unsigned int calls, ms;
+    const char *name = PSP->tail_len ? PSP->tail : LOOKUP_FILE;
+
+    calls = bench_run(lookup, (void *)name, 10, &ms);
+    if (!calls) {
+        puts("File not found.\n");
+        exit(1);
+    }
+    puts("lookup ");
+    bench_report(name, calls, ms, "lookups");
+
+    calls = bench_run(lookup_missing, MISSING_FILE, 10, &ms);
+    bench_report("lookup of a missing file", calls, ms, "lookups");
+
+    return 0;
+}
@@ -0,0 +1,28 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+/* Print the command tail, e.g. 'echo Hello world'. The shell passes it in
+   the PSP (see tydos.h), where it is read in place. */
+
+#include "tydos.h"
+
+int main()
+{
+    if (!PSP->tail_len)
+        exit(1); /* Nothing to echo. */
+
+    puts(PSP->tail);
+    puts("\n");
+
+    return 0;
+}
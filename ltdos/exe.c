@@ -0,0 +1,143 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+/* This source file implements the kernel's program loader, which reads a
+   TyDOS executable (see exe.h) from the disk, relocates it to the chosen
+   load address and prepares it to run. */
+
+#include "exe.h"  /* Executable format.       */
+#include "kaux.h" /* For load_disk(), crc32(). */
+#include "mem.h"  /* For memset().            */
+
+#define SECTOR_SIZE 512
+
+const char *exe_errors[] = {"Ok\n",
+                            "Drive read error\n",
+                            "Not a TyDOS executable\n",
+                            "Corrupted executable\n",
+                            "Program too large\n",
+                            "Bad relocation in executable\n",
+                            "Program needs a newer runtime\n",
+                            "Program built for another CPU mode\n",
+                            "Program does not match its checksum\n"};
+
+unsigned char exe_verify;
+
+/* Flags a program must have to run on this kernel. */
+
+#ifdef TYDOS_PM
+#define EXE_MODE EXE_FLAG_32
+#else
+#define EXE_MODE 0
+#endif
+
+extern unsigned short rt_version; /* Version of the kernel runtime (rt.S). */
+
+/* Load the executable stored at byte 'offset' of the boot drive, in a slot
+   of at most 'max_size' bytes, such that its text starts at 'base'. The
+   program, its BSS and its stack must fit below 'limit'.
+
+   File contents are read sector by sector straight into place: since the
+   file need not start at a sector boundary, up to one sector (plus the
+   header) is written right before 'base', so the caller must leave that
+   much room there.
+
+   If 'check_size' is not zero, the file must be that long and have the
+   CRC-32 'check_crc', which is checked before anything is relocated.
+
+   Return EXE_OK and fill in 'image' on success. */
+
+int exe_load(unsigned int offset, unsigned int max_size, char *base, char *limit,
+             unsigned int check_size, unsigned int check_crc, struct exe_image_t *image)
+{
+    struct exe_header_t *header;
+    unsigned int lba, skew, first, sectors, file_size, image_size, i;
+    unsigned short *reloc;
+    char *dst;
+
+    lba = offset / SECTOR_SIZE;
+    skew = offset % SECTOR_SIZE;
+
+    /* Read the sectors holding the header, such that it ends up right
+       before 'base' (where the text will be). */
+
+    header = (struct exe_header_t *)(base - sizeof(struct exe_header_t));
+    dst = (char *)header - skew;
+    first = (skew + sizeof(struct exe_header_t) + SECTOR_SIZE - 1) / SECTOR_SIZE;
+
+    if (load_disk(lba, first, dst))
+        return EXE_ERR_READ;
+
+    /* Reject anything that does not look like an executable we can run. */
+
+    for (i = 0; i < EXE_SIGLEN; i++)
+        if (header->signature[i] != EXE_SIGNATURE[i])
+            return EXE_ERR_FORMAT;
+
+    if (header->version != EXE_VERSION || header->header_size != sizeof(struct exe_header_t))
+        return EXE_ERR_FORMAT;
+
+    if ((header->flags & EXE_FLAG_32) != EXE_MODE)
+        return EXE_ERR_MODE;
+
+    if (header->rt_version > rt_version)
+        return EXE_ERR_RUNTIME;
+
+    file_size = sizeof(struct exe_header_t) + header->text_size + header->data_size +
+                (header->reloc32_count + header->reloc16_count) * sizeof(unsigned short);
+    image_size = header->text_size + header->data_size + header->bss_size + header->stack_size;
+
+    if (file_size > max_size || header->entry >= header->text_size)
+        return EXE_ERR_SIZE;
+
+    sectors = (skew + file_size + SECTOR_SIZE - 1) / SECTOR_SIZE;
+
+    if (base + image_size > limit || dst + sectors * SECTOR_SIZE > limit)
+        return EXE_ERR_MEMORY;
+
+    /* Read text, data and the relocation table (BSS is not on disk). */
+
+    if (sectors > first && load_disk(lba + first, sectors - first, dst + first * SECTOR_SIZE))
+        return EXE_ERR_READ;
+
+    if (check_size && (check_size != file_size || crc32(header, file_size) != check_crc))
+        return EXE_ERR_CHECKSUM;
+
+    /* Relocate: add the load address to every absolute address. */
+
+    reloc = (unsigned short *)(base + header->text_size + header->data_size);
+
+    for (i = 0; i < header->reloc32_count; i++, reloc++) {
+        if (*reloc + 4 > header->text_size + header->data_size)
+            return EXE_ERR_RELOC;
+        *(unsigned int *)(base + *reloc) += (unsigned int)base;
+    }
+
+    for (i = 0; i < header->reloc16_count; i++, reloc++) {
+        if (*reloc + 2 > header->text_size + header->data_size)
+            return EXE_ERR_RELOC;
+        *(unsigned short *)(base + *reloc) += (unsigned short)(unsigned int)base;
+    }
+
+    /* Zero BSS in memory, over the relocation table we no longer need. */
+
+    memset(base + header->text_size + header->data_size, 0, header->bss_size);
+
+    image->base = base;
+    image->entry = base + header->entry;
+    image->brk = base + header->text_size + header->data_size + header->bss_size;
+    image->end = base + image_size;
+    image->stack = (void *)((unsigned int)image->end & ~0xf);
+
+    return EXE_OK;
+}
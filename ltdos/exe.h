@@ -0,0 +1,98 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+/* TyDOS executable format.
+
+   This header is shared by the kernel loader (exe.c) and by the host tool
+   that produces executables out of the linked ELF objects (mkexe.c), so it
+   must compile both freestanding under -m16 and on the host.
+
+   An executable file is laid out like this:
+
+      -------------------------------------------------
+     | Header | Text | Data | Relocations (32) (16)   |
+      -------------------------------------------------
+
+   Programs are linked at address 0. Text (code and read-only data) is
+   immediately followed by initialized data; BSS is not stored in the file
+   at all. The relocation table lists the offsets (relative to the start of
+   text) of every absolute address in the image: first 'reloc32_count'
+   32-bit fields, then 'reloc16_count' 16-bit fields. The loader adds the
+   load address to each of them.
+
+   Since the relocation table sits exactly where BSS will be, the loader
+   reads text+data+relocations in a single pass, patches the image, and then
+   zeroes BSS over the (no longer needed) table.
+
+   Programs linked against librt.a call the runtime hosted by the kernel
+   (see rt.inc) instead of carrying their own copy; 'rt_version' is then
+   the runtime version they were built against. */
+
+#ifndef EXE_H
+#define EXE_H
+
+#define EXE_SIGNATURE "TyX"   /* Executable signature (with the NUL).     */
+#define EXE_SIGLEN 4          /* Signature length.                        */
+#define EXE_VERSION 2         /* Current version of the format.           */
+#define EXE_STACK_SIZE 0x800  /* Default stack size requested by mkexe.   */
+
+/* The executable header. */
+
+struct exe_header_t {
+    unsigned char signature[EXE_SIGLEN]; /* The executable signature.            */
+    unsigned short version;              /* Format version (EXE_VERSION).        */
+    unsigned short header_size;          /* Header size (text starts after it).  */
+    unsigned short entry;                /* Entry point, relative to text.       */
+    unsigned short text_size;            /* Code and read-only data, in bytes.   */
+    unsigned short data_size;            /* Initialized data, in bytes.          */
+    unsigned short bss_size;             /* Zero-initialized data, in bytes.     */
+    unsigned short stack_size;           /* Stack required by the program.       */
+    unsigned short reloc32_count;        /* Number of 32-bit relocations.        */
+    unsigned short reloc16_count;        /* Number of 16-bit relocations.        */
+    unsigned short rt_version;           /* Shared runtime required (0: none).   */
+    unsigned short flags;                /* EXE_FLAG_* below.                    */
+} __attribute__((packed));               /* Disable alignment to preserve offsets.*/
+
+/* Executable flags. */
+
+#define EXE_FLAG_32 0x0001 /* 32-bit code, for the protected-mode kernel. */
+
+/* Kernel loader (exe.c). */
+
+#define EXE_OK 0          /* Program loaded.                            */
+#define EXE_ERR_READ 1    /* Disk read error.                           */
+#define EXE_ERR_FORMAT 2  /* Not a TyDOS executable (or wrong version). */
+#define EXE_ERR_SIZE 3    /* Sizes inconsistent with the file.          */
+#define EXE_ERR_MEMORY 4  /* Program does not fit in memory.            */
+#define EXE_ERR_RELOC 5   /* Relocation out of the image.               */
+#define EXE_ERR_RUNTIME 6 /* Needs a newer kernel runtime.              */
+#define EXE_ERR_MODE 7    /* Built for the other (16/32-bit) kernel.    */
+#define EXE_ERR_CHECKSUM 8 /* File does not match its CRC-32.           */
+
+extern const char *exe_errors[]; /* Error messages, indexed by EXE_ERR_*. */
+extern unsigned char exe_verify; /* 'verify on': check programs' CRC-32. */
+
+/* A program loaded in memory and ready to run. */
+
+struct exe_image_t {
+    char *base;  /* Load address (start of text).   */
+    void *entry; /* Entry point.                    */
+    void *stack; /* Initial stack pointer.          */
+    char *brk;   /* End of BSS, bottom of the stack.*/
+    char *end;   /* End of the program and stack.   */
+};
+
+int exe_load(unsigned int offset, unsigned int max_size, char *base, char *limit,
+             unsigned int check_size, unsigned int check_crc, struct exe_image_t *image);
+
+#endif /* EXE_H  */
@@ -0,0 +1,114 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+
+/* This source file implements the memory footprint accounting (see
+   footprint.h). */
+
+#include "footprint.h"
+#include "mem.h" /* For memsetw(), memcpy(). */
+
+extern int _PROG_END;  /* End of the program area (tydos.ld).     */
+extern int _BEGIN_STACK; /* Bottom of the kernel stack (tydos.ld). */
+extern int _END_STACK; /* Top of the kernel stack (tydos.ld).     */
+
+struct footprint_t foot_history[FOOT_HISTORY];
+unsigned int foot_runs;
+unsigned char foot_verbose;
+
+static struct exe_image_t foot_image; /* The program running.     */
+
+/* Paint the words from 'start' up to 'end' (both word-aligned). */
+
+static void paint(void *start, void *end)
+{
+    if ((char *)end > (char *)start)
+        memsetw(start, FOOT_CANARY, ((char *)end - (char *)start) / 2);
+}
+
+/* Return the first word still painted from 'start' up to 'end', or 'end'. */
+
+static unsigned short *first_touched(unsigned short *start, unsigned short *end)
+{
+    while (start < end && *start == FOOT_CANARY)
+        start++;
+    return start;
+}
+
+/* Paint the kernel stack below the caller's frame (kmain's), leaving
+   room for the frames of this function, paint() and memsetw(). */
+
+void footprint_init(void)
+{
+    unsigned short here;
+
+    paint(&_BEGIN_STACK, (void *)(((unsigned int)&here - 256) & ~1));
+}
+
+/* Return the deepest the kernel stack has gone since boot, in bytes. */
+
+unsigned int footprint_kstack(void)
+{
+    return (char *)&_END_STACK -
+           (char *)first_touched((unsigned short *)&_BEGIN_STACK, (unsigned short *)&_END_STACK);
+}
+
+/* Paint the stack and the free area of the program 'name', just loaded. */
+
+void footprint_start(const char *name, struct exe_image_t *image)
+{
+    struct footprint_t *foot = &foot_history[foot_runs % FOOT_HISTORY];
+    unsigned int len = strlen(name);
+
+    if (len > sizeof(foot->name) - 1)
+        len = sizeof(foot->name) - 1;
+    memcpy(foot->name, name, len);
+    foot->name[len] = 0;
+
+    /* Keep the bounds word-aligned, to scan word by word. */
+
+    memcpy(&foot_image, image, sizeof(foot_image));
+    foot_image.brk = (char *)(((unsigned int)image->brk + 1) & ~1);
+    foot_image.end = (char *)(((unsigned int)image->end + 1) & ~1);
+    paint(foot_image.brk, image->stack);
+    paint(foot_image.end, &_PROG_END);
+}
+
+/* Account the run of the program that just returned with 'status'. */
+
+struct footprint_t *footprint_stop(int status)
+{
+    struct footprint_t *foot = &foot_history[foot_runs++ % FOOT_HISTORY];
+    unsigned short *p, *top;
+
+    foot->image = foot_image.brk - foot_image.base;
+    foot->stack = (char *)foot_image.stack - foot_image.brk;
+    foot->status = status;
+
+    /* The stack grows down from image.stack. */
+
+    p = first_touched((unsigned short *)foot_image.brk, foot_image.stack);
+    foot->used = (char *)foot_image.stack - (char *)p;
+
+    /* The highest word written above the stack, if any. */
+
+    top = (unsigned short *)foot_image.stack;
+    for (p = (unsigned short *)&_PROG_END; p > (unsigned short *)foot_image.end; p--)
+        if (p[-1] != FOOT_CANARY) {
+            top = p;
+            break;
+        }
+    foot->top = (unsigned int)top;
+
+    return foot;
+}
@@ -0,0 +1,54 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+
+/* Memory footprint of the programs run.
+
+   Before a program runs, footprint_start() paints its stack and the free
+   part of the program area above it with FOOT_CANARY; when the program
+   returns, footprint_stop() looks for the words that lost the pattern to
+   find the stack's high-water mark and the highest address the program
+   wrote. The kernel stack, below _END_STACK, is painted once at boot
+   (footprint_init) and tells the deepest the kernel has gone so far.
+
+   Stack overflows into BSS are not seen (BSS is not painted), but a stack
+   used to its very bottom is reported as full. The last FOOT_HISTORY runs
+   are kept for the shell's 'footprint' built-in. */
+
+#ifndef FOOTPRINT_H
+#define FOOTPRINT_H
+
+#include "exe.h" /* For struct exe_image_t. */
+
+#define FOOT_CANARY 0x5aa5 /* Paint pattern (a word).   */
+#define FOOT_HISTORY 8     /* Runs kept.                */
+
+struct footprint_t {
+    char name[16];        /* Program file name.                      */
+    unsigned short image; /* Text, data and BSS, in bytes.           */
+    unsigned short stack; /* Stack reserved by the executable.       */
+    unsigned short used;  /* Stack high-water mark.                  */
+    unsigned short top;   /* Highest address written, plus one.      */
+    int status;           /* Exit status.                            */
+};
+
+extern struct footprint_t foot_history[FOOT_HISTORY]; /* Ring of runs. */
+extern unsigned int foot_runs;                       /* Runs so far.  */
+extern unsigned char foot_verbose;                   /* 'footprint on'. */
+
+void footprint_init(void);
+void footprint_start(const char *name, struct exe_image_t *image);
+struct footprint_t *footprint_stop(int status);
+unsigned int footprint_kstack(void);
+
+#endif /* FOOTPRINT_H  */
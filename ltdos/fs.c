@@ -0,0 +1,178 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+
+/* This source file implements the kernel's access to the TyFS volume (see
+   fs.h). */
+
+#include "fs.h"
+#include "kaux.h" /* For load_disk(). */
+#include "mem.h"  /* For memcpy(). */
+
+#ifdef TYDOS_HOST
+extern char host_disk[]; /* Stand-ins for the volume, from the boot  */
+extern char host_pool[]; /* sector on, and for the memory pool.      */
+#define FS_HEADER ((struct fs_header_t *)host_disk)
+#define FS_POOL host_pool
+#define FS_POOL_SIZE (8 * SECTOR_SIZE) /* As in kbench.c. */
+#else
+extern int _MEM_POOL;    /* Memory pool, below the kernel stack,       */
+extern int _BEGIN_STACK; /* where it ends (tydos.ld).                  */
+#define FS_HEADER ((struct fs_header_t *)BOOT_START)
+#define FS_POOL ((char *)&_MEM_POOL)
+#define FS_POOL_SIZE ((char *)&_BEGIN_STACK - FS_POOL)
+#endif
+
+/* Helper function to get header address.
+ * Arguments: (none)
+ */
+struct fs_header_t *get_fs_header() { return FS_HEADER; }
+
+/* Return the number of sectors of the directory.
+ * Arguments: (none)
+ */
+unsigned int fs_dir_sectors(void) { return tyfs_dir_sectors(get_fs_header()); }
+
+/* Load the directory region into the memory pool and return its address,
+ * or 0 on a read error or if the directory does not fit in the pool.
+ * Arguments: (none)
+ */
+char *fs_load_directory()
+{
+    struct fs_header_t *header = get_fs_header();
+    char *directory = FS_POOL;
+
+    if (fs_dir_sectors() * SECTOR_SIZE > FS_POOL_SIZE)
+        return 0;
+
+    /* The directory starts right after the boot sectors. */
+
+    if (load_disk(tyfs_dir_offset(header) / SECTOR_SIZE, fs_dir_sectors(), directory))
+        return 0;
+
+    return directory;
+}
+
+/* Return the directory slot of file 'name', or -1 if not found.
+ * Arguments: <file-name>
+ */
+int fs_lookup(const char *name)
+{
+    char *directory = fs_load_directory();
+
+    if (!directory)
+        return -1;
+
+    return tyfs_lookup(get_fs_header(), directory, name);
+}
+
+/* The entry of 'slot' in the directory loaded by the last fs_lookup(),
+   valid until the memory pool is used for something else. */
+
+struct fs_entry_t *fs_entry(int slot) { return tyfs_entry(FS_POOL, slot); }
+
+/* Return the byte offset in the disk where the contents of 'slot' start.
+ * Arguments: <slot>
+ */
+unsigned int fs_slot_offset(int slot) { return tyfs_slot_offset(get_fs_header(), slot); }
+
+/* The open files: their slots, lengths and read positions. A slot of 0
+   marks a free entry, so slots are kept plus one. */
+
+static struct fs_file_t {
+    int slot;
+    unsigned int length;
+    unsigned int position;
+} fs_files[FS_FILES];
+
+/* Open file 'name' for reading and return its descriptor, or -1 if the
+ * file does not exist or too many files are open. The file is as long as
+ * the size recorded for it, or else its whole cluster (see tyfs.h); that
+ * is taken now, while fs_lookup() has the directory in the pool.
+ * Arguments: <file-name>
+ */
+int fs_open(const char *name)
+{
+    struct fs_header_t *header = get_fs_header();
+    struct fs_file_t *file;
+    int fd, slot, size;
+
+    for (fd = 0; fd < FS_FILES; fd++)
+        if (!fs_files[fd].slot)
+            break;
+    if (fd == FS_FILES)
+        return -1;
+
+    slot = fs_lookup(name);
+    if (slot < 0)
+        return -1;
+
+    file = &fs_files[fd];
+    size = tyfs_entry_size(header, fs_entry(slot));
+    file->slot = slot + 1;
+    file->length = size < 0 ? tyfs_file_size(header) : size;
+    file->position = 0;
+    return fd;
+}
+
+/* Read up to 'size' bytes of file 'fd' into 'buffer' and return how many
+ * were read (0 at the end of the file), or -1 on error. Whole sectors go
+ * straight to the buffer; the pool bounces the partial ones, since the
+ * file areas need not start at a sector boundary (see fs_slot_offset).
+ * Arguments: <descriptor> <buffer> <size>
+ */
+int fs_read(int fd, char *buffer, unsigned int size)
+{
+    struct fs_file_t *file;
+    unsigned int offset, skew, n, done;
+
+    if (fd < 0 || fd >= FS_FILES || !fs_files[fd].slot)
+        return -1;
+
+    file = &fs_files[fd];
+
+    if (size > file->length - file->position)
+        size = file->length - file->position;
+    offset = fs_slot_offset(file->slot - 1) + file->position;
+
+    for (done = 0; done < size; done += n, offset += n) {
+        skew = offset % SECTOR_SIZE;
+        if (!skew && size - done >= SECTOR_SIZE) {
+            n = (size - done) / SECTOR_SIZE * SECTOR_SIZE;
+            if (load_disk(offset / SECTOR_SIZE, n / SECTOR_SIZE, buffer + done))
+                return -1;
+        } else {
+            n = SECTOR_SIZE - skew;
+            if (n > size - done)
+                n = size - done;
+            if (load_disk(offset / SECTOR_SIZE, 1, FS_POOL))
+                return -1;
+            memcpy(buffer + done, FS_POOL + skew, n);
+        }
+    }
+
+    file->position += size;
+    return size;
+}
+
+/* Close file 'fd'. Return 0, or -1 if it was not open.
+ * Arguments: <descriptor>
+ */
+int fs_close(int fd)
+{
+    if (fd < 0 || fd >= FS_FILES || !fs_files[fd].slot)
+        return -1;
+
+    fs_files[fd].slot = 0;
+    return 0;
+}
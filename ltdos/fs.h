@@ -0,0 +1,49 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+
+/* TyFS volume, as seen by the kernel.
+
+   The volume header is the start of the boot sector, which the BIOS left
+   at BOOT_START. The layout of the volume (see tyfs/tyfs.h) is worked out
+   by libtyfs, the same code tyfsedit uses.
+
+   Programs read files through a small table of open files (FS_FILES),
+   each with its own read position. A file reads as long as the size its
+   entry records, or, in entries that record none, as its whole cluster
+   of max_file_size sectors.
+
+   This code is plain C, so it also builds on the host, with TYDOS_HOST
+   defined, for kbench (see kbench.c). */
+
+#ifndef FS_H
+#define FS_H
+
+#include "tyfs/tyfs.h" /* Volume layout. */
+
+#define BOOT_START 0x7c00
+
+struct fs_header_t *get_fs_header();
+unsigned int fs_dir_sectors(void);
+char *fs_load_directory();
+int fs_lookup(const char *name);
+unsigned int fs_slot_offset(int slot);
+struct fs_entry_t *fs_entry(int slot);
+
+#define FS_FILES 4 /* Files open at a time. */
+
+int fs_open(const char *name);
+int fs_read(int fd, char *buffer, unsigned int size);
+int fs_close(int fd);
+
+#endif /* FS_H  */
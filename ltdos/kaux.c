@@ -13,10 +13,23 @@
 
 #include "kaux.h"  /* For ROWS and COLS. */
 #include "bios2.h" /* For udelay().      */
+#include "mem.h"   /* For memsetw().     */
+#ifndef TYDOS_HOST
+#include "stats.h" /* For disk_stats.    */
+#include "trace.h" /* For TRACE().       */
+#endif
+#ifdef TYDOS_PM
+#include "pm.h" /* For bios_int().    */
+#endif
 
 /* Video RAM as 2D matrix: short vram[row][col]. */
 
+#ifdef TYDOS_HOST
+static short host_vram[ROWS][COLS]; /* A stand-in (see kbench.c). */
+short (*vram)[COLS] = host_vram;
+#else
 short (*vram)[COLS] = (short (*)[COLS])0xb8000;
+#endif
 
 char character_color = 0x02; /* Default fore/background character color.*/
 
@@ -47,21 +60,16 @@ void writexy(unsigned char row, unsigned char col, const char *string)
 
  */
 
-void clearxy()
-{
-    int i, j;
+void clearxy() { memsetw(vram, color_char(' '), ROWS * COLS); }
 
-    for (j = 0; j < ROWS; j++)
-        for (i = 0; i < COLS; i++)
-            vram[j][i] = color_char(' ');
-}
-
-/* A not-that-impressive splash screen that is entirely superfluous. */
+/* A not-that-impressive splash screen that is entirely superfluous.
+   Kernels built with FASTBOOT skip it. */
 
 extern const char logo[];
 void splash(void)
 {
-    int i, j, k;
+#ifndef FASTBOOT
+    int i, j;
 
     clearxy();
 
@@ -75,62 +83,220 @@ void splash(void)
 
     udelay(500);
     clearxy();
+#endif
 }
 
-/* Return 0 is string 's1' and 's2' are equal; return non-zero otherwise.*/
+/* Function to convert unsigned integer types to string.
 
-int strcmp(const char *s1, const char *s2)
+   Digits are produced least significant first, so they are stored from
+   the end of a scratch buffer backwards and then copied out in order. */
+
+void uint_to_string(unsigned int num, char *str)
 {
-    while (*s1 && *s2 && *s1 == *s2) {
-        s1++;
-        s2++;
-    }
-    return (*s1 - *s2);
+    char digits[10]; /* Enough for 2^32 - 1. */
+    char *p = digits + sizeof(digits);
+
+    do {
+        *--p = '0' + num % 10;
+        num /= 10;
+    } while (num);
+
+    memcpy(str, p, digits + sizeof(digits) - p);
+    str[digits + sizeof(digits) - p] = '\0';
 }
 
-/* Function to convert unsigned integer types to string. */
-void uint_to_string(unsigned int num, char *str)
+/* The same in hexadecimal (lower case), with zeros in front up to at
+   least 'width' digits; 'str' must hold 9 bytes. */
+
+void uint_to_hex(unsigned int num, char *str, int width)
 {
+    static const char hex[] = "0123456789abcdef";
+    char digits[8];
+    int i = 0;
 
-    // Handle special case when num is 0
-    if (num == 0) {
-        str[0] = '0';
-        str[1] = '\0';
-        return;
-    }
+    do {
+        digits[i++] = hex[num & 0xf];
+        num >>= 4;
+    } while (num || i < width);
 
-    // Start building the string from the end
-    int index = 0;
-    while (num != 0) {
-        unsigned int digit = num % 10;
-        str[index++] = '0' + digit; // convert digit to character
-        num /= 10;
+    while (i)
+        *str++ = digits[--i];
+    *str = '\0';
+}
+
+/* Return 'n' / 'd', or ~0 if the quotient does not fit in 32 bits.
+   GCC would otherwise call __udivdi3 from libgcc, which we don't link. */
+
+unsigned int udiv64(unsigned long long n, unsigned int d)
+{
+    unsigned int hi = n >> 32, lo = n, q;
+
+    if (hi >= d)
+        return ~0;
+
+    __asm__("divl %2" : "=a"(q), "+d"(hi) : "rm"(d), "0"(lo));
+    return q;
+}
+
+/* Return the CRC-32 of 'size' bytes at 'data', as zlib's crc32() (and
+   tyfsedit) compute it. Bit by bit, to spare the kernel a table. */
+
+unsigned int crc32(const void *data, unsigned int size)
+{
+    const unsigned char *p = data;
+    unsigned int crc = ~0, i;
+
+    while (size--) {
+        crc ^= *p++;
+        for (i = 0; i < 8; i++)
+            crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
     }
-    str[index] = '\0';
-
-    // Reverse the string in place
-    int start = 0;
-    int end = index - 1;
-    while (start < end) {
-        char temp = str[start];
-        str[start] = str[end];
-        str[end] = temp;
-        start++;
-        end--;
+
+    return ~crc;
+}
+
+#ifndef TYDOS_HOST /* The host has no disk (see kbench.c). */
+
+/* Read 'count' sectors starting at logical block 'lba' of the boot drive
+   into 'target'. The request is split at track boundaries, using the drive
+   geometry queried by the bootloader (bios1.S). Return 0 on success or the
+   BIOS error code otherwise. Successful reads are accounted in disk_stats. */
+
+int load_disk(unsigned int lba, unsigned int count, void *target)
+{
+    unsigned int sector, head, cylinder, n, status, drive, reset;
+    unsigned char error;
+    char *dst = target;
+    int retry;
+    unsigned int start = rdtsc32(), sectors = count;
+
+    TRACE(TRACE_DISK, 0, count, lba);
+
+    while (count) {
+        sector = lba % disk_sectors;
+        head = (lba / disk_sectors) % disk_heads;
+        cylinder = lba / disk_sectors / disk_heads;
+
+        n = disk_sectors - sector; /* Up to the end of the track. */
+        if (n > count)
+            n = count;
+
+        for (retry = 0; retry < 3; retry++) {
+#ifdef TYDOS_PM
+            /* The BIOS is only reachable from real mode (see bios_int). */
+
+            struct bios_regs_t regs = {
+                .ax = 0x0200 | n, /* BIOS disk service: op. read sector. */
+                .bx = (unsigned int)dst & 0xf, /* Where to load the sectors, */
+                .es = (unsigned int)dst >> 4,  /* as a real-mode es:bx.      */
+                .cx = ((cylinder & 0xff) << 8) | ((cylinder >> 2) & 0xc0) | (sector + 1),
+                .dx = (head << 8) | boot_drive};
+
+            error = bios_int(0x13, &regs);
+            status = regs.ax;
+            if (!error)
+                break;
+
+            regs.ax = 0; /* On error, reset the drive and try again. */
+            regs.dx = boot_drive;
+            bios_int(0x13, &regs);
+#else
+            status = 0x0200 | n; /* BIOS disk service: op. read sector. */
+            drive = head << 8;   /* Head coordinate (the drive is set below). */
+            __asm__ volatile("mov boot_drive, %%dl \n" /* Select the boot drive (from rt0.o). */
+                             "int $0x13 \n"            /* Call BIOS disk service 0x13.        */
+                             : "=@ccc"(error), "+a"(status), "+d"(drive)
+                             : "b"(dst), /* Where to load the sectors.  */
+                               "c"(((cylinder & 0xff) << 8) | ((cylinder >> 2) & 0xc0) | (sector + 1))
+                             : "memory");
+            if (!error)
+                break;
+
+            reset = 0; /* On error, reset the drive and try again. */
+            __asm__ volatile("mov boot_drive, %%dl \n"
+                             "int $0x13 \n"
+                             : "+a"(reset), "=d"(drive)
+                             :
+                             : "memory", "cc");
+#endif
+        }
+        if (error) {
+            TRACE(TRACE_DISK_DONE, (status >> 8) & 0xff, 0, 0);
+            return (status >> 8) & 0xff;
+        }
+
+        lba += n;
+        count -= n;
+        dst += n * 512;
     }
+
+    stats_add(&disk_stats, rdtsc32() - start, sectors);
+    TRACE(TRACE_DISK_DONE, 0, sectors, 0);
+    return 0;
 }
 
-void load_disk(int sector_coordinate, int readSectors, void *target_addres)
+/* Return a millisecond clock, for programs to time themselves (see
+   clock() in tydos.h). The protected-mode kernel counts its own timer
+   ticks since boot; in real mode this is the BIOS time of day, which
+   advances every 1/18.2 s, i.e. in steps of about 55 ms. */
+
+unsigned int uptime(void)
 {
-    __asm__ volatile("pusha \n"
-                     "mov boot_drive, %%dl \n"    /* Select the boot drive (from rt0.o). */
-                     "mov $0x2, %%ah \n"          /* BIOS disk service: op. read sector. */
-                     "mov %[sectToRead], %%al \n" /* How many sectors to read          */
-                     "mov $0x0, %%ch \n"          /* Cylinder coordinate (starts at 0).  */
-                     "mov %[sectCoord], %%cl \n"  /* Sector coordinate   (starts at 1).  */
-                     "mov $0x0, %%dh \n"          /* Head coordinate     (starts at 0).      */
-                     "mov %[targetAddr], %%bx \n" /* Where to load the file system (rt0.o).   */
-                     "int $0x13 \n"               /* Call BIOS disk service 0x13.        */
-                     "popa \n" ::[sectCoord] "g"(sector_coordinate),
-                     [sectToRead] "g"(readSectors), [targetAddr] "g"(target_addres));
+#ifdef TYDOS_PM
+    return ticks * (1000 / PIT_HZ);
+#else
+    unsigned int hi, lo, service = 0; /* BIOS time service: read the ticks. */
+
+    __asm__ volatile("int $0x1a" : "+a"(service), "=c"(hi), "=d"(lo) : : "cc");
+    return udiv64((unsigned long long)((hi & 0xffff) << 16 | (lo & 0xffff)) * 549254, 10000);
+#endif
+}
+
+#endif /* TYDOS_HOST */
+
+/* The first serial port (COM1), programmed directly so that it works
+   the same in both kernel builds. Used to dump data to the host and, as
+   a second keyboard, to drive the shell from a script (see 'make bench'). */
+
+#define COM1 0x3f8
+
+unsigned char serial_present;
+
+void serial_init(void)
+{
+    outb(COM1 + 1, 0x00); /* No interrupts.                */
+    outb(COM1 + 3, 0x80); /* Set the divisor:              */
+    outb(COM1 + 0, 0x01); /* 115200 baud.                  */
+    outb(COM1 + 1, 0x00);
+    outb(COM1 + 3, 0x03); /* 8 bits, no parity, 1 stop.    */
+    outb(COM1 + 2, 0xc7); /* FIFO on, cleared.             */
+
+    serial_present = inb(COM1 + 5) != 0xff; /* No port reads all ones. */
+}
+
+void serial_putc(char c)
+{
+    while (!(inb(COM1 + 5) & 0x20)) /* Wait for the transmitter. */
+        ;
+    outb(COM1, c);
+}
+
+void serial_puts(const char *s)
+{
+    while (*s)
+        serial_putc(*s++);
+}
+
+/* Return the next character received, or -1 if there is none. Line feeds
+   read as carriage returns, i.e. as Enter, like a terminal would send. */
+
+int serial_getc(void)
+{
+    unsigned char c;
+
+    if (!serial_present || !(inb(COM1 + 5) & 0x01)) /* Data ready? */
+        return -1;
+
+    c = inb(COM1);
+    return c == '\n' ? '\r' : c;
 }
@@ -30,8 +30,6 @@ void halt(void);   /* Halt the system.                       */
 
 #define color_char(ascii) ((character_color << 8) + ascii)
 
-int strcmp(const char *s1, const char *s2);
-
 int syscall();
 
 void register_syscall_handler();
@@ -42,6 +40,54 @@ void writexy(unsigned char, unsigned char, const char *);
 void clearxy(void);
 
 void uint_to_string(unsigned int num, char *str);
+void uint_to_hex(unsigned int num, char *str, int width);
+unsigned int udiv64(unsigned long long n, unsigned int d);
+unsigned int crc32(const void *data, unsigned int size);
+
+void serial_init(void); /* COM1, 115200 8N1, polled (at boot). */
+void serial_putc(char c);
+void serial_puts(const char *s);
+int serial_getc(void);  /* Next input character, or -1.      */
+
+extern unsigned char serial_present; /* COM1 found by serial_init(). */
+
+int load_disk(unsigned int lba, unsigned int count, void *target);
+unsigned int uptime(void); /* Milliseconds, for clock() (see tydos.h). */
+
+extern unsigned char boot_drive;   /* Boot drive (from rt0.S).              */
+extern unsigned char disk_sectors; /* Drive geometry (from bios1.S).        */
+extern unsigned char disk_heads;
+
+/* Read the low 32 bits of the CPU time-stamp counter. */
+
+static inline unsigned int rdtsc32(void)
+{
+    unsigned int lo, hi;
+    __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return lo;
+}
+
+/* Read the whole time-stamp counter. */
+
+static inline unsigned long long rdtsc64(void)
+{
+    unsigned long long tsc;
+    __asm__ volatile("rdtsc" : "=A"(tsc));
+    return tsc;
+}
+
+/* Port I/O. */
+
+static inline unsigned char inb(unsigned short port)
+{
+    unsigned char value;
+    __asm__ volatile("inb %1, %0" : "=a"(value) : "Nd"(port));
+    return value;
+}
+
+static inline void outb(unsigned short port, unsigned char value)
+{
+    __asm__ volatile("outb %0, %1" : : "a"(value), "Nd"(port));
+}
 
-void load_disk(int sector_coordinate, int readSectors, void *target_addres);
 #endif /* KLIB_H  */
@@ -0,0 +1,366 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+
+/* kbench - time the kernel's portable C routines on the host.
+
+   Usage: kbench [-n iterations]
+
+   kbench is built from the kernel's own kaux.c, fs.c and libtyfs.c (see
+   tyfs/tyfs.h), compiled for the host with TYDOS_HOST defined: video RAM
+   becomes an array, and the disk is a volume made up in memory
+   (host_disk), read by the load_disk() stub below. Each routine is first
+   checked against known results, since a wrong routine is not worth
+   timing, and then run 'iterations' times (default 1000000, fewer for
+   the slower ones) to report the time per call in nanoseconds. kbench
+   exits with status 1 if any check fails.
+
+   libtyfs is also run on a large volume (big_directory), the most files
+   a header can describe; going through its directory is reported as a
+   throughput too, in MB of directory per second.
+
+   Timings are those of the host, not of TyDOS, but the code is compiled
+   with the kernel's -O0 so that changes to a routine compare fairly.
+   This is a host program: it runs on the build machine, not on TyDOS. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "fs.h"
+#include "kaux.h"
+#include "tyfs/tyfs.h"
+
+/* The volume: header and boot sectors, then the directory, and the
+   start of the first file, the only one read. Files 0 and 2 record their
+   size (100 bytes, and none: empty), file 1 records none, and file 3 has
+   a name that runs over its size, as on volumes with 32-byte names. */
+
+#define HOST_BOOT_SECTORS 48
+#define HOST_ENTRIES 88
+#define HOST_FILE_SECTORS 32
+
+char host_disk[(HOST_BOOT_SECTORS + 8) * SECTOR_SIZE];
+char host_pool[8 * SECTOR_SIZE];
+
+int load_disk(unsigned int lba, unsigned int count, void *target)
+{
+    if ((lba + count) * SECTOR_SIZE > sizeof(host_disk))
+        return 1;
+    memcpy(target, host_disk + lba * SECTOR_SIZE, count * SECTOR_SIZE);
+    return 0;
+}
+
+void make_volume(void)
+{
+    struct fs_header_t *header = (struct fs_header_t *)host_disk;
+    char *directory = host_disk + HOST_BOOT_SECTORS * SECTOR_SIZE;
+    int i;
+
+    header->total_number_of_sectors = 2880;
+    header->number_of_boot_sectors = HOST_BOOT_SECTORS;
+    header->max_file_size = HOST_FILE_SECTORS;
+    tyfs_format(header); /* HOST_ENTRIES entries (checked). */
+
+    for (i = 0; i < HOST_ENTRIES; i++)
+        snprintf(directory + i * DIR_ENTRY_LEN, DIR_ENTRY_LEN, "file%02d.bin", i);
+
+    tyfs_entry(directory, 0)->size = 100 | FS_SIZE_RECORDED;
+    tyfs_entry(directory, 2)->size = 0 | FS_SIZE_RECORDED;
+    memcpy(tyfs_entry(directory, 3)->name, "file03.bin-with-a-longer", FS_NAME_LEN);
+    tyfs_entry(directory, 3)->size = 5 | FS_SIZE_RECORDED;
+}
+
+/* The large volume: 0xffff sectors, one boot sector and one-sector files,
+   all slots in use but the last. Only the header and the directory are
+   made up. */
+
+struct fs_header_t big_header;
+char *big_directory;
+unsigned int big_entries;
+
+void make_big_volume(void)
+{
+    unsigned int i;
+
+    big_header.total_number_of_sectors = 0xffff;
+    big_header.number_of_boot_sectors = 1;
+    big_header.max_file_size = 1;
+    big_entries = tyfs_format(&big_header);
+
+    big_directory = calloc(big_entries, DIR_ENTRY_LEN);
+    if (!big_directory) {
+        perror("kbench");
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < big_entries - 1; i++)
+        snprintf(big_directory + i * DIR_ENTRY_LEN, FS_NAME_LEN, "file%05u.bin", i);
+}
+
+/* Stubs for what the kernel gets from assembly. */
+
+void *memsetw(void *dst, int w, unsigned int n)
+{
+    unsigned short *p = dst;
+
+    while (n--)
+        *p++ = w;
+    return dst;
+}
+
+void udelay(unsigned short t) {}
+
+/* Checks. */
+
+int checks, failures;
+
+void check(int ok, const char *what)
+{
+    checks++;
+    if (!ok) {
+        fprintf(stderr, "kbench: check failed: %s\n", what);
+        failures++;
+    }
+}
+
+void check_string(const char *got, const char *expected, const char *what)
+{
+    checks++;
+    if (strcmp(got, expected)) {
+        fprintf(stderr, "kbench: check failed: %s: '%s', expected '%s'\n", what, got,
+                expected);
+        failures++;
+    }
+}
+
+extern short (*vram)[COLS];
+
+void run_tyfs_checks(void)
+{
+    struct fs_header_t *header = (struct fs_header_t *)host_disk, bad;
+    unsigned int i, n;
+    char name[FS_NAME_LEN + 1];
+
+    check(header->number_of_file_entries == HOST_ENTRIES, "tyfs_format() entries");
+    check(header->unused_space ==
+              (2880 - HOST_BOOT_SECTORS) * SECTOR_SIZE -
+                  HOST_ENTRIES * (DIR_ENTRY_LEN + HOST_FILE_SECTORS * SECTOR_SIZE),
+          "tyfs_format() unused space");
+    check(!memcmp(header->signature, FS_SIGNATURE, FS_SIGLEN), "tyfs_format() signature");
+    check(big_entries == (0xffff - 1) * SECTOR_SIZE / (DIR_ENTRY_LEN + SECTOR_SIZE),
+          "tyfs_format() entries, large volume");
+
+    bad = *header;
+    bad.number_of_boot_sectors = bad.total_number_of_sectors;
+    check(tyfs_format(&bad) == -1, "tyfs_format() too many boot sectors");
+    bad = *header;
+    bad.max_file_size = 0;
+    check(tyfs_format(&bad) == -1, "tyfs_format() empty files");
+    bad = *header;
+    bad.max_file_size = 0xffff;
+    check(tyfs_format(&bad) == 0, "tyfs_format() no file fits");
+
+    /* The floppy volume needs 48 + 6 + 88 * 32 sectors. */
+
+    check(tyfs_check(header, 2880) == TYFS_OK, "tyfs_check()");
+    check(tyfs_check(header, 2870) == TYFS_OK, "tyfs_check() exact");
+    check(tyfs_check(header, 2869) == TYFS_ERR_LAYOUT, "tyfs_check() short volume");
+    check(tyfs_check(&big_header, 0xffff) == TYFS_OK, "tyfs_check() large volume");
+    bad = *header;
+    bad.signature[0] = 0;
+    check(tyfs_check(&bad, 2880) == TYFS_ERR_SIGNATURE, "tyfs_check() signature");
+    bad = *header;
+    bad.number_of_boot_sectors = bad.number_of_file_entries = bad.max_file_size = 0xffff;
+    check(tyfs_check(&bad, 0xffff) == TYFS_ERR_LAYOUT, "tyfs_check() corrupt header");
+
+    check(tyfs_dir_offset(header) == HOST_BOOT_SECTORS * SECTOR_SIZE, "tyfs_dir_offset()");
+    check(tyfs_file_size(header) == HOST_FILE_SECTORS * SECTOR_SIZE, "tyfs_file_size()");
+    check(tyfs_slot_offset(&big_header, big_entries - 1) + SECTOR_SIZE <=
+              big_header.total_number_of_sectors * SECTOR_SIZE,
+          "tyfs_slot_offset() last, large volume");
+
+    for (n = 0, i = tyfs_next(&big_header, big_directory, -1); i != -1;
+         i = tyfs_next(&big_header, big_directory, i))
+        n++;
+    check(n == big_entries - 1, "tyfs_next() goes through all files");
+    check(tyfs_free_slot(&big_header, big_directory) == big_entries - 1, "tyfs_free_slot()");
+    check(tyfs_free_slot(header, host_disk + tyfs_dir_offset(header)) == -1,
+          "tyfs_free_slot() full");
+
+    snprintf(name, sizeof(name), "file%05u.bin", big_entries - 2);
+    check(tyfs_lookup(&big_header, big_directory, name) == big_entries - 2,
+          "tyfs_lookup() last, large volume");
+    check(tyfs_lookup(&big_header, big_directory, "") == -1, "tyfs_lookup() empty name");
+    check(tyfs_lookup(&big_header, big_directory, "file00000.bi") == -1,
+          "tyfs_lookup() prefix");
+    memset(name, 'a', FS_NAME_LEN);
+    name[FS_NAME_LEN] = 0;
+    memcpy(big_directory, name, FS_NAME_LEN); /* Not NUL-terminated. */
+    check(tyfs_lookup(&big_header, big_directory, name) == -1, "tyfs_lookup() name too long");
+    snprintf(big_directory, FS_NAME_LEN, "file%05u.bin", 0);
+    memset(big_directory + FS_NAME_LEN, 0, DIR_ENTRY_LEN - FS_NAME_LEN);
+}
+
+void run_checks(void)
+{
+    char str[12], buffer[SECTOR_SIZE];
+    int row, col, clear, fd;
+
+    uint_to_string(0, str);
+    check_string(str, "0", "uint_to_string(0)");
+    uint_to_string(10, str);
+    check_string(str, "10", "uint_to_string(10)");
+    uint_to_string(4294967295u, str);
+    check_string(str, "4294967295", "uint_to_string(2^32 - 1)");
+
+    check(udiv64(10, 3) == 3, "udiv64(10, 3)");
+    check(udiv64(5000000000ull, 1000) == 5000000, "udiv64(5e9, 1000)");
+    check(udiv64(1ull << 32, 1) == ~0u, "udiv64 overflow");
+
+    clearxy();
+    for (clear = 1, row = 0; row < ROWS; row++)
+        for (col = 0; col < COLS; col++)
+            clear &= vram[row][col] == color_char(' ');
+    check(clear, "clearxy()");
+
+    writexy(1, COLS - 1, "ab");
+    check(vram[1][COLS - 1] == color_char('a') && vram[1][0] == color_char('b'),
+          "writexy() wraps around the row");
+    writexy(ROWS, 2, "c");
+    check(vram[0][2] == color_char('c'), "writexy() wraps around the screen");
+
+    check(fs_dir_sectors() == 6, "fs_dir_sectors()");
+    check(fs_slot_offset(0) == HOST_BOOT_SECTORS * SECTOR_SIZE + HOST_ENTRIES * DIR_ENTRY_LEN,
+          "fs_slot_offset(0)");
+    check(fs_slot_offset(3) - fs_slot_offset(2) == HOST_FILE_SECTORS * SECTOR_SIZE,
+          "fs_slot_offset() stride");
+    check(fs_lookup("file00.bin") == 0, "fs_lookup() first");
+    check(fs_lookup("file87.bin") == HOST_ENTRIES - 1, "fs_lookup() last");
+    check(fs_lookup("nothing") == -1, "fs_lookup() missing");
+
+    check(tyfs_entry_size(get_fs_header(), fs_entry(0)) == 100, "tyfs_entry_size() recorded");
+    check(tyfs_entry_size(get_fs_header(), fs_entry(1)) == -1, "tyfs_entry_size() none");
+    check(tyfs_entry_size(get_fs_header(), fs_entry(2)) == 0, "tyfs_entry_size() empty");
+    check(tyfs_entry_size(get_fs_header(), fs_entry(3)) == -1, "tyfs_entry_size() long name");
+
+    fd = fs_open("file00.bin");
+    check(fs_read(fd, buffer, sizeof(buffer)) == 100 && fs_read(fd, buffer, sizeof(buffer)) == 0,
+          "fs_read() stops at the recorded size");
+    fs_close(fd);
+    fd = fs_open("file02.bin");
+    check(fs_read(fd, buffer, sizeof(buffer)) == 0, "fs_read() empty file");
+    fs_close(fd);
+
+    run_tyfs_checks();
+}
+
+/* Benchmarks. */
+
+volatile unsigned int sink; /* Results go here, so that they are used. */
+
+void bench_uint_to_string(void)
+{
+    char str[12];
+    uint_to_string(4294967295u, str);
+    sink = str[0];
+}
+
+void bench_udiv64(void) { sink = udiv64(5000000000ull, 1000); }
+void bench_writexy(void) { writexy(0, 0, "The quick brown fox jumps over the lazy dog."); }
+void bench_clearxy(void) { clearxy(); }
+void bench_dir_sectors(void) { sink = fs_dir_sectors(); }
+void bench_slot_offset(void) { sink = fs_slot_offset(sink & 0x3f); }
+void bench_lookup_first(void) { sink = fs_lookup("file00.bin"); }
+void bench_lookup_miss(void) { sink = fs_lookup("nothing"); }
+
+void bench_tyfs_next(void)
+{
+    int i;
+
+    for (i = tyfs_next(&big_header, big_directory, -1); i >= 0;
+         i = tyfs_next(&big_header, big_directory, i))
+        sink = i;
+}
+
+void bench_tyfs_lookup(void) { sink = tyfs_lookup(&big_header, big_directory, "nothing"); }
+void bench_tyfs_free_slot(void) { sink = tyfs_free_slot(&big_header, big_directory); }
+
+struct {
+    const char *name;
+    void (*funct)(void);
+    int divisor; /* Run this fraction of the iterations.      */
+    int big;     /* Goes through the whole big_directory.     */
+} benchs[] = {{"uint_to_string", bench_uint_to_string, 1, 0},
+              {"udiv64", bench_udiv64, 1, 0},
+              {"writexy (44 chars)", bench_writexy, 1, 0},
+              {"clearxy", bench_clearxy, 10, 0},
+              {"fs_dir_sectors", bench_dir_sectors, 1, 0},
+              {"fs_slot_offset", bench_slot_offset, 1, 0},
+              {"fs_lookup (first)", bench_lookup_first, 10, 0},
+              {"fs_lookup (miss)", bench_lookup_miss, 10, 0},
+              {"tyfs_next (all)", bench_tyfs_next, 10000, 1},
+              {"tyfs_lookup (miss)", bench_tyfs_lookup, 10000, 1},
+              {"tyfs_free_slot", bench_tyfs_free_slot, 10000, 1},
+              {0, 0, 0, 0}};
+
+double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+    int i;
+    long n, iterations = 1000000, k;
+    double start, ns;
+
+    /* No getopt(): unistd.h's syscall() clashes with the kernel's. */
+
+    if (argc == 3 && !strcmp(argv[1], "-n"))
+        iterations = atol(argv[2]);
+    else if (argc != 1) {
+        fprintf(stderr, "usage: kbench [-n iterations]\n");
+        return EXIT_FAILURE;
+    }
+
+    make_volume();
+    make_big_volume();
+    run_checks();
+    if (failures) {
+        fprintf(stderr, "kbench: %d of %d checks failed\n", failures, checks);
+        return EXIT_FAILURE;
+    }
+    printf("%d checks passed\n\n", checks);
+
+    printf("%-20s %10s %10s\n", "routine", "ns/op", "MB/s");
+    for (i = 0; benchs[i].name; i++) {
+        n = iterations / benchs[i].divisor;
+        if (n < 1)
+            n = 1;
+        start = now();
+        for (k = 0; k < n; k++)
+            benchs[i].funct();
+        ns = (now() - start) / n;
+        if (benchs[i].big)
+            printf("%-20s %10.1f %10.1f\n", benchs[i].name, ns,
+                   big_entries * DIR_ENTRY_LEN * 1e3 / ns);
+        else
+            printf("%-20s %10.1f\n", benchs[i].name, ns);
+    }
+
+    return EXIT_SUCCESS;
+}
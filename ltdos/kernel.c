@@ -19,22 +19,21 @@
 #include "bios1.h"  /* For kwrite() etc.            */
 #include "bios2.h"  /* For kread() etc.             */
 #include "kaux.h"   /* Auxiliary kernel functions.  */
-
-#define DIR_ENTRY_LEN 32 /* Max file name length in bytes.           */
-#define SECTOR_SIZE 512
-#define BOOT_START 0x7c00
-#define PROGRAM_ADDRESS 0xFE00
-#define FS_SIGLEN 4 /* Signature length.                        */
-
-/* The file header. */
-struct fs_header_t {
-    unsigned char signature[FS_SIGLEN];     /* The file system signature.              */
-    unsigned short total_number_of_sectors; /* Number of 512-byte disk blocks.         */
-    unsigned short number_of_boot_sectors;  /* Sectors reserved for boot code.         */
-    unsigned short number_of_file_entries;  /* Maximum number of files in the disk.    */
-    unsigned short max_file_size;           /* Maximum size of a file in blocks.       */
-    unsigned int unused_space;              /* Remaining space less than max_file_size.*/
-} __attribute__((packed));                  /* Disable alignment to preserve offsets.  */
+#include "exe.h"    /* Program loader.              */
+#include "mem.h"    /* Memory primitives.           */
+#include "tydos.h"  /* For the PSP.                  */
+#include "stats.h"  /* Performance counters.        */
+#include "trace.h"  /* Event trace.                 */
+#include "prof.h"   /* Sampling profiler.           */
+#include "footprint.h" /* Memory footprint.         */
+#include "fs.h"     /* TyFS volume.                 */
+
+extern int _PROG_ADDR; /* Where programs are loaded (tydos.ld).        */
+extern int _PROG_END;  /* End of the program area (tydos.ld).          */
+
+static void cmd_hash_init();
+static void write_footprint(struct footprint_t *foot);
+static void bench_report(const char *kind, unsigned int kcycles, const char *what);
 
 /* Kernel's entry function. */
 
@@ -42,9 +41,18 @@ void kmain(void)
 {
     int i, j;
 
+    boot_mark(BOOT_LOAD);
+
+    cmd_hash_init();  /* Index the built-in commands.         */
+    footprint_init(); /* Paint the kernel stack.              */
+    serial_init();    /* Serial port, for dumps and scripts.  */
+    boot_mark(BOOT_KERNEL);
+
     register_syscall_handler(); /* Register syscall handler at int 0x21.*/
+    boot_mark(BOOT_SYSCALL);
 
     splash(); /* Uncessary spash screen.              */
+    boot_mark(BOOT_SPLASH);
 
     shell(); /* Invoke the command-line interpreter. */
 
@@ -55,42 +63,105 @@ void kmain(void)
 
 char buffer[BUFF_SIZE];
 int go_on = 1;
+char *cmd_tail;      /* Command tail of the current command.   */
+int exit_status;     /* Exit status of the last program.       */
+
+static struct cmd_t *cmd_hash[CMD_HASH_SIZE]; /* Built-ins, by name hash. */
+
+/* Return the bucket of the command named 'name'. */
+
+static unsigned int cmd_bucket(const char *name)
+{
+    unsigned int h = 0;
+
+    while (*name)
+        h = h * 31 + (unsigned char)*name++;
+
+    return h & (CMD_HASH_SIZE - 1);
+}
+
+/* Insert every built-in command into the hash. */
+
+static void cmd_hash_init()
+{
+    int i;
+    unsigned int h;
+
+    for (i = 0; cmds[i].funct; i++) {
+        h = cmd_bucket(cmds[i].name);
+        cmds[i].next = cmd_hash[h];
+        cmd_hash[h] = &cmds[i];
+    }
+}
+
+/* Return the built-in command named 'name', or 0. */
+
+static struct cmd_t *cmd_find(const char *name)
+{
+    struct cmd_t *cmd;
+
+    for (cmd = cmd_hash[cmd_bucket(name)]; cmd; cmd = cmd->next)
+        if (!strcmp(name, cmd->name))
+            return cmd;
+
+    return 0;
+}
+
+/* Blanks separate the command name from its tail. */
+
+#define IS_BLANK(c) ((c) == ' ' || (c) == '\t')
 
 void shell()
 {
     int i;
+    char *name;
+
     clear();
     kwrite("TinyDOS 1.0\n");
+    boot_mark(BOOT_SHELL);
 
     while (go_on) {
 
-        /* Read the user input.
-         Commands are single-word ASCII tokens with no blanks. */
+        /* Read the user input. */
+
         do {
             kwrite(PROMPT);
-            kread(buffer);
-        } while (!buffer[0]);
-
-        /* Check for matching built-in commands */
-
-        i = 0;
-        while (cmds[i].funct) {
-            if (!strcmp(buffer, cmds[i].name)) {
-                cmds[i].funct();
-                break;
-            }
-            i++;
-        }
+            TRACE(TRACE_KBD_WAIT, 0, 0, 0);
+            i = kread(buffer, BUFF_SIZE);
+            TRACE(TRACE_KBD_DONE, 0, i, 0);
+            for (name = buffer; IS_BLANK(*name); name++)
+                ;
+        } while (!*name);
+
+        run_command(name);
+    }
+}
 
-        /* If the user input does not match any built-in command name, just
-           ignore and read the next command. If we were to execute external
-           programs, on the other hand, this is where we would search for a
-           corresponding file with a matching name in the storage device,
-           load it and transfer it the execution. Left as exercise. */
+/* Run the command line 'line' (with no leading blanks), which is split in
+   place into the command name and its tail. */
 
-        if (!cmds[i].funct)
-            kwrite("Command not found\n");
-    }
+void run_command(char *line)
+{
+    char *p;
+    struct cmd_t *cmd;
+
+    /* Split the command name from the command tail (in place). */
+
+    for (p = line; *p && !IS_BLANK(*p); p++)
+        ;
+    if (*p)
+        *p++ = 0;
+    while (IS_BLANK(*p))
+        p++;
+    cmd_tail = p;
+
+    /* Built-in commands take precedence over programs in the volume. */
+
+    cmd = cmd_find(line);
+    if (cmd)
+        cmd->funct();
+    else if (run_program(line, cmd_tail) < 0)
+        kwrite("Command not found\n");
 }
 
 /* Array with built-in command names and respective function pointers.
@@ -98,8 +169,18 @@ void shell()
 
 struct cmd_t cmds[] = {{"help", f_help}, /* Print a help message.       */
                        {"quit", f_quit}, /* Exit TyDOS.                 */
-                       {"exec", f_exec}, /* Execute an example program. */
+                       {"exec", f_exec}, /* Execute a program.          */
                        {"list", f_list}, /* List files */
+                       {"membench", f_membench}, /* Time memory primitives. */
+                       {"rtbench", f_rtbench},   /* Time the screen routines. */
+                       {"stats", f_stats},       /* Show the counters.      */
+                       {"resetstats", f_resetstats}, /* Zero the counters.  */
+                       {"trace", f_trace},       /* Event trace.            */
+                       {"prof", f_prof},         /* Sampling profiler.      */
+                       {"boottime", f_boottime}, /* Boot timeline.          */
+                       {"footprint", f_footprint}, /* Program memory use.   */
+                       {"time", f_time},         /* Time a command.         */
+                       {"verify", f_verify},     /* Check programs' CRC-32. */
                        {0, 0}};
 
 /* Build-in shell command: help. */
@@ -108,99 +189,626 @@ void f_help()
 {
     kwrite("...me, Obi-Wan, you're my only hope!\n\n");
     kwrite("   But we can try also some commands:\n");
-    kwrite("      exec    (to execute an user program example\n");
+    kwrite("      exec    [<program> [args]] (to run a program, hello.bin by default)\n");
     kwrite("      list    (to list all files present in disk\n");
+    kwrite("      membench (to time the memory primitives)\n");
+    kwrite("      rtbench (to time the screen routines)\n");
+    kwrite("      stats   (to show syscall, disk and console counters)\n");
+    kwrite("      resetstats (to zero the counters)\n");
+    kwrite("      trace   [on|off|clear|dump] (to show or control the trace)\n");
+    kwrite("      prof    [on|off|dump] (to profile the programs run)\n");
+    kwrite("      boottime (to show how long each boot stage took)\n");
+    kwrite("      footprint [on|off] (to show the memory programs used)\n");
+    kwrite("      time    <command> (to time a command)\n");
+    kwrite("      verify  [on|off] (to check programs' CRC-32 before running)\n");
     kwrite("      quit    (to exit TyDOS)\n");
+    kwrite("   or the name of any program in the disk, with arguments.\n");
 }
 
 void f_quit()
 {
     kwrite("Program halted. Bye.");
+    outb(0xf4, 0); /* Power off QEMU's isa-debug-exit, if present. */
     go_on = 0;
 }
 
-/* Built-in shell command: example.
+/* List files in the volume.
+ * Arguments: (none)
+ */
+void f_list()
+{
+    int i;
+    struct fs_header_t *header = get_fs_header();
+    char *directory = fs_load_directory();
+
+    if (!directory) {
+        kwrite("Drive read error\n");
+        return;
+    }
+
+    /* Go through the files in the directory. */
+    for (i = tyfs_next(header, directory, -1); i >= 0; i = tyfs_next(header, directory, i)) {
+        kwrite(tyfs_entry(directory, i)->name);
+        kwrite("\n");
+    }
+}
 
-   Execute an example user program which invokes a syscall.
+/* Load the program 'name' from the volume, relocated to the program
+ * area, and run it with the command tail 'tail'. If there is no such file,
+ * try 'name' with a ".bin" extension. Return -1 if the file was not found,
+ * or 0 otherwise; the program's exit status is left in 'exit_status'.
+ */
+int run_program(const char *name, const char *tail)
+{
+    struct fs_header_t *header = get_fs_header();
+    struct exe_image_t image;
+    struct footprint_t *foot;
+    struct fs_entry_t *entry;
+    unsigned int len;
+    int slot, size, rs;
+
+    len = strlen(name);
+    if (len > PSP_NAME_SIZE - sizeof(".bin"))
+        return -1;
+
+    memcpy(PSP->name, name, len + 1);
+    slot = fs_lookup(PSP->name);
+    if (slot < 0) {
+        memcpy(PSP->name + len, ".bin", sizeof(".bin"));
+        slot = fs_lookup(PSP->name);
+    }
+    if (slot < 0)
+        return -1;
+
+    /* With 'verify on', check the program against its CRC-32, if recorded. */
+
+    entry = fs_entry(slot);
+    size = tyfs_entry_size(header, entry);
+
+    TRACE(TRACE_LOAD, 0, slot, fs_slot_offset(slot));
+    rs = exe_load(fs_slot_offset(slot), tyfs_file_size(header), (char *)&_PROG_ADDR,
+                  (char *)&_PROG_END, exe_verify && size > 0 ? size : 0, entry->crc, &image);
+    TRACE(TRACE_LOAD_DONE, rs, 0, rs == EXE_OK ? (unsigned int)image.entry : 0);
+    if (rs != EXE_OK) {
+        kwrite(exe_errors[rs]);
+        exit_status = rs;
+        return 0;
+    }
 
-   The example program (built from the source 'prog.c') is statically linked
-   to the kernel by the linker script (tydos.ld). In order to extend the
-   example, and load and external C program, edit 'f_exec' and 'prog.c' choosing
-   a different name for the entry function, such that it does not conflict with
-   the 'main' function of the external program.  Even better: remove 'f_exec'
-   entirely, and suppress the 'example_program' section from the tydos.ld, and
-   edit the Makefile not to include 'prog.o' and 'libtydos.o' from 'tydos.bin'.
+    /* The command tail goes to the PSP, where the program reads it. */
+
+    len = strlen(tail);
+    if (len > PSP_TAIL_SIZE - 1)
+        len = PSP_TAIL_SIZE - 1;
+    memcpy(PSP->tail, tail, len);
+    PSP->tail[len] = 0;
+    PSP->tail_len = len;
+
+    footprint_start(PSP->name, &image);
+    prof_start(PSP->name, image.base, image.end);
+    exit_status = exec(image.entry, image.stack);
+    prof_stop();
+    foot = footprint_stop(exit_status);
+
+    if (foot_verbose)
+        write_footprint(foot);
+
+    if (exit_status) {
+        char str[12];
+        kwrite("Exit status ");
+        uint_to_string(exit_status, str);
+        kwrite(str);
+        kwrite("\n");
+    }
 
-  */
+    return 0;
+}
 
-/* Helper function to get header address.
- * Arguments: (none)
+/* Built-in shell command: exec.
+ *
+ * Execute the program named in the command tail, with the rest of the
+ * tail as its arguments, or by default the example user program built
+ * from 'hello.c'. The shell does the same for a command line that names
+ * a program in the volume (see run_program).
+ *
+ * Programs are TyDOS executables stored in the volume (see exe.h). They
+ * are loaded and relocated into the program area (tydos.ld) and called
+ * on their own stack.
  */
-struct fs_header_t *get_fs_header() { return (struct fs_header_t *)BOOT_START; }
+void f_exec()
+{
+    char *name = cmd_tail, *p;
 
-/* List files in the volume.
- * Arguments: (none)
+    if (!*name)
+        name = "hello.bin";
+
+    for (p = name; *p && !IS_BLANK(*p); p++)
+        ;
+    if (*p)
+        *p++ = 0;
+    while (IS_BLANK(*p))
+        p++;
+
+    if (run_program(name, p) < 0)
+        kwrite("Program not found.\n");
+}
+
+/* Built-in shell command: membench.
+ *
+ * Time the memory and string primitives (mem.S) against plain byte loops
+ * over a BENCH_SIZE block in the program area (unused while a built-in
+ * runs), and print the best of BENCH_RUNS runs in CPU cycles and in
+ * bytes per cycle.
  */
-void f_list()
+
+#define BENCH_SIZE 4096
+#define BENCH_RUNS 8
+
+static char *bench_src, *bench_dst;
+
+static void bench_byte_copy()
 {
     int i;
-    char name[DIR_ENTRY_LEN];
-    char buffer[6];
+    for (i = 0; i < BENCH_SIZE; i++)
+        bench_dst[i] = bench_src[i];
+}
 
-    struct fs_header_t *header = get_fs_header();
+static void bench_byte_fill()
+{
+    int i;
+    for (i = 0; i < BENCH_SIZE; i++)
+        bench_dst[i] = 0;
+}
 
-    /* Position at the begining of the directory region. */
-    unsigned int start_sector = header->number_of_boot_sectors + 1;
-    unsigned int n_sectors = header->number_of_file_entries * DIR_ENTRY_LEN / SECTOR_SIZE;
-
-    // void *section_pointer = (void *)(start_sector * SECTOR_SIZE);
-    extern int _MEM_POOL;
-    void *section_pointer = (void *)&_MEM_POOL;
-
-    load_disk(start_sector, n_sectors, section_pointer);
-    /* Read all entries. */
-    char *files = (char *)((char *)header + header->number_of_boot_sectors * SECTOR_SIZE);
-    for (i = 0; i < 4; i++) {
-        // char *name = &files[i * header->max_file_size];
-        char *name = section_pointer + i * DIR_ENTRY_LEN;
-        if (name[0]) {
-            kwrite(name);
-            kwrite("\n");
+static void bench_memcpy() { memcpy(bench_dst, bench_src, BENCH_SIZE); }
+static void bench_memmove() { memmove(bench_src + 1, bench_src, BENCH_SIZE - 1); }
+static void bench_memset() { memset(bench_dst, 0, BENCH_SIZE); }
+static void bench_strlen() { strlen(bench_src); }
+static void bench_strcmp() { strcmp(bench_src, bench_dst); }
+
+static struct {
+    const char *name;
+    void (*funct)();
+} benchs[] = {{"byte copy  ", bench_byte_copy}, {"memcpy     ", bench_memcpy},
+              {"memmove    ", bench_memmove},   {"byte fill  ", bench_byte_fill},
+              {"memset     ", bench_memset},    {"strlen     ", bench_strlen},
+              {"strcmp     ", bench_strcmp},    {0, 0}};
+
+void f_membench()
+{
+    char str[16];
+    unsigned int i, run, start, cycles, best, rate;
+
+    bench_src = (char *)&_PROG_ADDR;
+    bench_dst = bench_src + BENCH_SIZE + 1; /* Deliberately misaligned. */
+
+    for (i = 0; benchs[i].funct; i++) {
+
+        /* Strings of BENCH_SIZE - 1 equal bytes for strlen and strcmp. */
+
+        memset(bench_src, 'x', BENCH_SIZE);
+        memset(bench_dst, 'x', BENCH_SIZE);
+        bench_src[BENCH_SIZE - 1] = bench_dst[BENCH_SIZE - 1] = 0;
+
+        best = ~0;
+        for (run = 0; run < BENCH_RUNS; run++) {
+            start = rdtsc32();
+            benchs[i].funct();
+            cycles = rdtsc32() - start;
+            if (cycles < best)
+                best = cycles;
         }
+        if (!best)
+            best = 1;
+
+        rate = BENCH_SIZE * 100 / best; /* Bytes per cycle, times 100. */
+
+        kwrite(benchs[i].name);
+        uint_to_string(best, str);
+        kwrite(str);
+        kwrite(" cycles, ");
+        uint_to_string(rate / 100, str);
+        kwrite(str);
+        str[0] = '.';
+        str[1] = '0' + rate / 10 % 10;
+        str[2] = '0' + rate % 10;
+        str[3] = 0;
+        kwrite(str);
+        kwrite(" bytes/cycle\n");
     }
 }
 
-void f_exec()
+/* Built-in shell commands: stats and resetstats.
+ *
+ * Show the performance counters (see stats.h): for each syscall, the disk
+ * reads and the console writes, the number of events, their average,
+ * minimum and maximum duration in cycles, their total in thousands of
+ * cycles and the units of work (sectors read, bytes written). Console
+ * writes are those of programs only (see console_stats).
+ */
+
+static const char *syscall_names[SYS_COUNT] = {"invalid", "exit", "write", "gets", "null",
+                                                   "clock",   "open", "read",  "close"};
+
+/* Write 'n' right-aligned in a field of 'width' characters. */
+
+static void write_field(unsigned int n, int width)
 {
-    struct fs_header_t *header = get_fs_header();
+    char str[12];
+    int len;
 
-    /* Position at the begining of the directory region. */
-    unsigned int start_sector = header->number_of_boot_sectors + 1;
-    unsigned int n_sectors = header->number_of_file_entries * DIR_ENTRY_LEN / SECTOR_SIZE;
+    uint_to_string(n, str);
+    for (len = strlen(str); len < width; len++)
+        kwrite(" ");
+    kwrite(str);
+}
 
-    int memoryOffset = header->number_of_file_entries * 32 - (n_sectors - 1) * 512;
+/* Write 'name' left-aligned in a field of 'width' characters. */
 
-    void *section_pointer = (void *)(start_sector * SECTOR_SIZE);
+static void write_name(const char *name, int width)
+{
+    int len;
 
-    load_disk(start_sector, n_sectors, section_pointer);
+    kwrite(name);
+    for (len = strlen(name); len < width; len++)
+        kwrite(" ");
+}
 
-    int bin_sector_coord = -1;
-    for (int i = 0; i < header->number_of_file_entries; i++) {
-        char *file_name = section_pointer + i * DIR_ENTRY_LEN;
-        if (!strcmp(file_name, "hello.bin")) {
-            bin_sector_coord = start_sector + n_sectors + header->max_file_size * i - 1;
-            break;
+static void write_stat(const char *name, struct stat_t *stat)
+{
+    write_name(name, 8);
+    write_field(stat->count, 8);
+    write_field(stat->count ? udiv64(stat->total, stat->count) : 0, 10);
+    write_field(stat->min, 10);
+    write_field(stat->max, 10);
+    write_field(udiv64(stat->total, 1000), 11);
+    write_field(stat->units, 9);
+    kwrite("\n");
+}
+
+void f_stats()
+{
+    int i;
+
+    kwrite("event      count       avg       min       max  kcycles    units\n");
+    for (i = 0; i < SYS_COUNT; i++)
+        write_stat(syscall_names[i], &syscall_stats[i]);
+    write_stat("disk", &disk_stats);
+    write_stat("console", &console_stats);
+}
+
+void f_resetstats() { stats_reset(); }
+
+/* Built-in shell command: trace.
+ *
+ * 'trace on' and 'trace off' start and stop recording events (see trace.h),
+ * 'trace clear' empties the ring and 'trace dump' sends it to the serial
+ * port, for tytrace. With no argument, show the last TRACE_SHOW events,
+ * each with the cycles elapsed since the previous one.
+ */
+
+#define TRACE_SHOW 20
+
+static const char *trace_names[TRACE_TYPES] = TRACE_NAMES;
+
+void f_trace()
+{
+    struct trace_event_t *event, *prev;
+    unsigned int i, n;
+
+    if (!strcmp(cmd_tail, "on"))
+        trace_enabled = 1;
+    else if (!strcmp(cmd_tail, "off"))
+        trace_enabled = 0;
+    else if (!strcmp(cmd_tail, "clear"))
+        trace_clear();
+    else if (!strcmp(cmd_tail, "dump"))
+        trace_dump();
+    else if (cmd_tail[0])
+        kwrite("Usage: trace [on|off|clear|dump]\n");
+    else {
+        n = trace_length();
+        i = n > TRACE_SHOW ? n - TRACE_SHOW : 0;
+        kwrite("    cycles  event       arg  value  st\n");
+        for (prev = 0; i < n; i++, prev = event) {
+            event = trace_get(i);
+            write_field(prev ? (unsigned int)(event->tsc - prev->tsc) : 0, 10);
+            kwrite("  ");
+            write_name(event->type < TRACE_TYPES ? trace_names[event->type] : "?", 10);
+            write_field(event->arg, 5);
+            write_field(event->value, 7);
+            write_field(event->status, 4);
+            kwrite("\n");
         }
+        kwrite(trace_enabled ? "Tracing is on, " : "Tracing is off, ");
+        write_field(trace_count, 0);
+        kwrite(" events recorded.\n");
     }
-    if (bin_sector_coord == -1) {
-        kwrite("Program not found.\n");
+}
+
+/* Built-in shell command: prof.
+ *
+ * 'prof on' and 'prof off' arm and disarm the profiler (see prof.h) for the
+ * next programs run, and 'prof dump' sends the last profile to the serial
+ * port, for typrof. With no argument, show where the last program run spent
+ * its time, and its PROF_SHOW hottest buckets (offsets in the program).
+ */
+
+#define PROF_SHOW 10
+
+/* Write 'n' in hexadecimal, right-aligned in a field of 'width'. */
+
+static void write_hex(unsigned int n, int width)
+{
+    char str[9];
+
+    uint_to_hex(n, str, 0);
+    for (n = strlen(str); n < width; n++)
+        kwrite(" ");
+    kwrite(str);
+}
+
+void f_prof()
+{
+    unsigned int i, n, best, count, shown;
+
+    if (!strcmp(cmd_tail, "on"))
+        prof_enabled = 1;
+    else if (!strcmp(cmd_tail, "off"))
+        prof_enabled = 0;
+    else if (!strcmp(cmd_tail, "dump"))
+        prof_dump();
+    else if (cmd_tail[0])
+        kwrite("Usage: prof [on|off|dump]\n");
+    else if (!prof_samples)
+        kwrite(prof_enabled ? "No profile yet: run a program.\n"
+                            : "No profile: arm the profiler with 'prof on'.\n");
+    else {
+        kwrite(prof_name);
+        kwrite(": ");
+        write_field(prof_samples, 0);
+        kwrite(" samples, program ");
+        write_field(prof_program, 0);
+        kwrite(", kernel ");
+        write_field(prof_kernel, 0);
+        kwrite(", BIOS ");
+        write_field(prof_bios, 0);
+        kwrite("\n  offset  samples\n");
+
+        /* The hottest buckets first: pick the best one still not shown,
+           i.e. below the last count shown (or equal, but after it). */
+
+        count = ~0;
+        best = 0;
+        for (shown = 0; shown < PROF_SHOW; shown++) {
+            n = prof_buckets;
+            for (i = 0; i < prof_buckets; i++)
+                if (_PROF_HIST[i] && (_PROF_HIST[i] < count || (_PROF_HIST[i] == count && i > best)) &&
+                    (n == prof_buckets || _PROF_HIST[i] > _PROF_HIST[n]))
+                    n = i;
+            if (n == prof_buckets)
+                break;
+            best = n;
+            count = _PROF_HIST[n];
+            write_hex(n << PROF_SHIFT, 8);
+            write_field(count, 9);
+            kwrite("\n");
+        }
+    }
+}
+
+/* Built-in shell command: boottime.
+ *
+ * Show how long each boot stage took (see stats.h), in microseconds if
+ * the rate of the time-stamp counter can be measured, and in thousands
+ * of cycles. 'boottime dump' sends the latter to the serial port, for
+ * 'make bench' (see bench_report).
+ */
+
+static const char *boot_names[BOOT_STAGES] = BOOT_NAMES;
+
+static void write_boot_stage(const char *name, unsigned long long cycles, unsigned int khz)
+{
+    if (!strcmp(cmd_tail, "dump")) {
+        bench_report("boot", udiv64(cycles, 1000), name);
+        return;
+    }
+    write_name(name, 14);
+    if (khz)
+        write_field(udiv64(cycles * 1000, khz), 10);
+    else
+        write_name("        ?", 10);
+    write_field(udiv64(cycles, 1000), 11);
+    kwrite("\n");
+}
+
+void f_boottime()
+{
+    int i;
+    unsigned int khz = tsc_khz();
+    unsigned long long start = _BOOT_TSC;
+
+    if (cmd_tail[0] && strcmp(cmd_tail, "dump")) {
+        kwrite("Usage: boottime [dump]\n");
         return;
     }
 
-    void *program = (void *)(0xFE00);
-    void *program_sector_start = program - memoryOffset;
+    if (!cmd_tail[0])
+        kwrite("stage               usec    kcycles\n");
+    for (i = 0; i < BOOT_STAGES; i++) {
+        write_boot_stage(boot_names[i], boot_tsc[i] - start, khz);
+        start = boot_tsc[i];
+    }
+    write_boot_stage("boot to prompt", boot_tsc[BOOT_SHELL] - _BOOT_TSC, khz);
+}
 
-    load_disk(bin_sector_coord, header->max_file_size, program_sector_start);
+/* Built-in shell command: footprint.
+ *
+ * Show the memory footprint (see footprint.h) of the last FOOT_HISTORY
+ * programs run: the size of the image (text, data and BSS), the stack
+ * reserved and the most of it used, the highest address written and the
+ * memory left free above it, up to the end of the program area. Then the
+ * deepest the kernel stack has gone. 'footprint on' also shows the
+ * footprint after each run.
+ */
+
+extern int _PROG_END, _BEGIN_STACK, _END_STACK; /* See tydos.ld. */
+
+static void write_footprint(struct footprint_t *foot)
+{
+    write_name(foot->name, 14);
+    write_field(foot->image, 6);
+    write_field(foot->stack, 7);
+    write_field(foot->used, 7);
+    write_hex(foot->top, 7);
+    write_field((char *)&_PROG_END - (char *)(unsigned int)foot->top, 7);
+    write_field(foot->status, 7);
+    kwrite(foot->used >= foot->stack ? "  stack full!\n" : "\n");
+}
+
+void f_footprint()
+{
+    unsigned int i;
+
+    if (!strcmp(cmd_tail, "on"))
+        foot_verbose = 1;
+    else if (!strcmp(cmd_tail, "off"))
+        foot_verbose = 0;
+    else if (cmd_tail[0])
+        kwrite("Usage: footprint [on|off]\n");
+    else {
+        kwrite("program        image  stack   used    top   free status\n");
+        i = foot_runs > FOOT_HISTORY ? foot_runs - FOOT_HISTORY : 0;
+        for (; i < foot_runs; i++)
+            write_footprint(&foot_history[i % FOOT_HISTORY]);
+        kwrite("kernel stack: ");
+        write_field(footprint_kstack(), 0);
+        kwrite(" of ");
+        write_field((char *)&_END_STACK - (char *)&_BEGIN_STACK, 0);
+        kwrite(" bytes used\n");
+    }
+}
+
+/* Built-in shell command: rtbench.
+ *
+ * Time the screen routines (in real mode, those of the BIOS runtime the
+ * kernel is linked with, see ../biosrt/README): clear, kwrite of COLS - 1
+ * characters and a CR, which does not scroll, and kwrite of a LF on the
+ * last line, which does. Print the best of BENCH_RUNS runs
+ * in cycles, also sent to the serial port (see bench_report) as
+ * 'TyBM rt <cycles> <routine>' lines, in cycles rather than thousands,
+ * for 'make biosrt-report'.
+ */
+
+static char rt_line[COLS + 1];
+
+static void rt_clear() { clear(); }
+static void rt_kwrite() { kwrite(rt_line); }
+static void rt_scroll() { kwrite("\n"); }
+
+static unsigned int rt_time(void (*funct)())
+{
+    unsigned int run, start, cycles, best = ~0;
+
+    for (run = 0; run < BENCH_RUNS; run++) {
+        start = rdtsc32();
+        funct();
+        cycles = rdtsc32() - start;
+        if (cycles < best)
+            best = cycles;
+    }
+    return best;
+}
+
+void f_rtbench()
+{
+    static const char *names[] = {"clear", "kwrite", "scroll"};
+    unsigned int cycles[3], i;
+
+    memset(rt_line, 'x', COLS - 1);
+    rt_line[COLS - 1] = '\r';
+
+    cycles[0] = rt_time(rt_clear);
+    cycles[1] = rt_time(rt_kwrite);
+    for (i = 0; i < ROWS; i++) /* Down to the last line. */
+        kwrite("\n");
+    cycles[2] = rt_time(rt_scroll);
+
+    for (i = 0; i < 3; i++) {
+        write_name(names[i], 8);
+        write_field(cycles[i], 10);
+        kwrite(" cycles\n");
+        bench_report("rt", cycles[i], names[i]);
+    }
+}
+
+/* Built-in shell command: time.
+ *
+ * Run the command tail as a command line and show how long it took, in
+ * thousands of cycles (keyboard waits included).
+ */
+
+void f_time()
+{
+    char line[BUFF_SIZE];
+    unsigned long long start;
+    unsigned int kcycles;
+
+    if (!cmd_tail[0]) {
+        kwrite("Usage: time <command>\n");
+        return;
+    }
+
+    memcpy(line, cmd_tail, strlen(cmd_tail) + 1); /* run_command() splits it. */
+
+    start = rdtsc64();
+    run_command(cmd_tail);
+    kcycles = udiv64(rdtsc64() - start, 1000);
+
+    write_field(kcycles, 0);
+    kwrite(" kcycles\n");
+    bench_report("time", kcycles, line);
+}
+
+/* Built-in shell command: verify.
+ *
+ * 'verify on' makes the loader check every program against the size and
+ * CRC-32 recorded in its directory entry (by tyfsedit), refusing to run
+ * it if they don't match; 'verify off' turns that off (the default).
+ * Files with no CRC-32 recorded are run unchecked.
+ */
+
+void f_verify()
+{
+    if (!strcmp(cmd_tail, "on"))
+        exe_verify = 1;
+    else if (!strcmp(cmd_tail, "off"))
+        exe_verify = 0;
+    else if (cmd_tail[0])
+        kwrite("Usage: verify [on|off]\n");
+    else
+        kwrite(exe_verify ? "Verification is on\n" : "Verification is off\n");
+}
+
+/* Send a benchmark result to the serial port as the line
+
+      TyBM <kind> <kcycles> <what>
+
+   which 'make bench' collects (see tybench.c). */
+
+static void bench_report(const char *kind, unsigned int kcycles, const char *what)
+{
+    char str[12];
+
+    if (!serial_present)
+        return;
 
-    exec();
+    uint_to_string(kcycles, str);
+    serial_puts("TyBM ");
+    serial_puts(kind);
+    serial_puts(" ");
+    serial_puts(str);
+    serial_puts(" ");
+    serial_puts(what);
+    serial_puts("\n");
 }
@@ -22,23 +22,45 @@ void kmain(void);
 /* This is the command interpreter, which is invoked by the kernel as
    soon as the boot is complete.
 
-   Our tiny command-line parser is too simple: commands are ASCII single words
-   with no command line arguments (no blanks). */
+   The first word of the command line is the command name; the rest of the
+   line, with the leading blanks removed, is its command tail. A name that
+   is not a built-in command is looked up in the volume, first as is and
+   then with a ".bin" extension, and the program is run with the tail in
+   its PSP (see tydos.h). */
 
 void shell();        /* Command interpreter. */
 #define BUFF_SIZE 64 /* Max command length.  */
 #define PROMPT "> "  /* Command-line prompt. */
 
+void run_command(char *line);                       /* Dispatch.      */
+int run_program(const char *name, const char *tail); /* Load and run.  */
+
+extern char *cmd_tail;   /* Command tail of the current command.   */
+extern int exit_status;  /* Exit status of the last program.       */
+
 /* Built-in commands. */
 
 void f_help();
 void f_exec();
 void f_quit();
 void f_list();
+void f_membench();
+void f_rtbench();
+void f_stats();
+void f_resetstats();
+void f_trace();
+void f_prof();
+void f_boottime();
+void f_footprint();
+void f_time();
+void f_verify();
 
 extern struct cmd_t {
     char name[32];
     void (*funct)();
+    struct cmd_t *next; /* Next command in the same hash bucket. */
 } cmds[];
 
+#define CMD_HASH_SIZE 16 /* Buckets of the built-in command hash (2^n). */
+
 #endif /* KERNEL_H  */
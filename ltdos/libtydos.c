@@ -24,22 +24,41 @@
 
 int syscall(int number, int arg1, int arg2, int arg3)
 {
-    __asm__("pusha \n"); /* We'll mess up with GP registers. */
-
     /* Our syscall ABI uses regparm(3) calling convention (see the section on
-       x86 function attributes in the GCC manual. */
+       x86 function attributes in the GCC manual. The handler preserves all
+       registers but %ax, which holds the return value. */
 
     int register bx __asm__("bx") = number; /* Syscall number (handler). */
     int register ax __asm__("ax") = arg1;   /* First argument  in %ax.   */
     int register dx __asm__("dx") = arg2;   /* Second argument in %dx.   */
     int register cx __asm__("cx") = arg3;   /* Third argument in  %cx.   */
 
-    __asm__("int $0x21 \n"  /* Issue int $0x21.                    */
-            "popa      \n " /* Restore GP registers.               */
-    );
+    __asm__ volatile("int $0x21 \n" /* Issue int $0x21.                    */
+                     : "+r"(ax)
+                     : "r"(bx), "r"(dx), "r"(cx)
+                     : "memory");
+    return ax;
 }
 
 /*  Write the string 'str' on the screen.*/
 
 void puts(const char *str) { syscall(SYS_WRITE, (int)str, 0, 0); }
 void gets(const char *str) { syscall(SYS_GETS, (int)str, 0, 0); }
+
+/* Terminate the program with exit status 'status'. */
+
+void exit(int status) { syscall(SYS_EXIT, status, 0, 0); }
+
+/* Do nothing, through the kernel. */
+
+int nop(void) { return syscall(SYS_NULL, 0, 0, 0); }
+
+/* Return a millisecond clock. */
+
+unsigned int clock(void) { return syscall(SYS_CLOCK, 0, 0, 0); }
+
+/* Read files from the volume. */
+
+int open(const char *name) { return syscall(SYS_OPEN, (int)name, 0, 0); }
+int read(int fd, void *buf, unsigned int n) { return syscall(SYS_READ, fd, (int)buf, n); }
+int close(int fd) { return syscall(SYS_CLOSE, fd, 0, 0); }
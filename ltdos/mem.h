@@ -0,0 +1,31 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+/* Memory and string primitives (mem.S), shared by the kernel and the user
+   library. They follow the usual C semantics. */
+
+#ifndef MEM_H
+#define MEM_H
+
+#ifdef TYDOS_HOST
+#include <string.h> /* The host has them all but memsetw (see kbench.c). */
+#else
+void *memcpy(void *dst, const void *src, unsigned int n);
+void *memmove(void *dst, const void *src, unsigned int n);
+void *memset(void *dst, int c, unsigned int n);
+unsigned int strlen(const char *s);
+int strcmp(const char *s1, const char *s2);
+#endif
+void *memsetw(void *dst, int w, unsigned int n); /* Fill 'n' 16-bit words. */
+
+#endif /* MEM_H  */
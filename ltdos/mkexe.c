@@ -0,0 +1,267 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+/* mkexe - build a TyDOS executable out of a linked user program.
+
+   Usage: mkexe [-s stack-size] [-m 16|32] <program.elf> <program.bin>
+
+   The input is the ELF file produced by 'ld -T prog.ld -q', i.e. linked at
+   address 0 with the relocations kept in the output (--emit-relocs); '-m 32'
+   marks programs compiled for the protected-mode kernel. This is a host
+   program: it runs on the build machine, not on TyDOS. */
+
+#include <elf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "exe.h"
+
+#define MAX_RELOCS 8192 /* Max number of relocations of each kind. */
+
+unsigned char *elf;  /* The whole input file.      */
+Elf32_Ehdr *ehdr;    /* ELF header.                */
+Elf32_Shdr *shdr;    /* Section header table.      */
+const char *strtab;  /* Section names.             */
+
+unsigned short reloc32[MAX_RELOCS]; /* Offsets of the 32-bit fixups. */
+unsigned short reloc16[MAX_RELOCS]; /* Offsets of the 16-bit fixups. */
+int n32, n16;
+
+/* Print an error message and exit. */
+
+void fatal(const char *msg, const char *arg)
+{
+    fprintf(stderr, "mkexe: %s%s%s\n", msg, arg ? ": " : "", arg ? arg : "");
+    exit(EXIT_FAILURE);
+}
+
+/* Return the section header with the given name, or NULL. */
+
+Elf32_Shdr *section(const char *name)
+{
+    int i;
+    for (i = 0; i < ehdr->e_shnum; i++)
+        if (!strcmp(strtab + shdr[i].sh_name, name))
+            return &shdr[i];
+    return NULL;
+}
+
+/* Return the value of the absolute symbol 'name', or 0 if not defined. */
+
+unsigned int symbol(const char *name)
+{
+    int i, j, n;
+    Elf32_Sym *sym;
+    const char *names;
+
+    for (i = 0; i < ehdr->e_shnum; i++) {
+        if (shdr[i].sh_type != SHT_SYMTAB)
+            continue;
+        sym = (Elf32_Sym *)(elf + shdr[i].sh_offset);
+        names = (const char *)(elf + shdr[shdr[i].sh_link].sh_offset);
+        n = shdr[i].sh_size / sizeof(Elf32_Sym);
+        for (j = 0; j < n; j++)
+            if (sym[j].st_shndx == SHN_ABS && !strcmp(names + sym[j].st_name, name))
+                return sym[j].st_value;
+    }
+    return 0;
+}
+
+/* Read the whole file 'name' into memory; return its size in 'size'. */
+
+unsigned char *slurp(const char *name, long *size)
+{
+    FILE *fp;
+    unsigned char *buf;
+
+    fp = fopen(name, "r");
+    if (!fp)
+        fatal("can't open", name);
+    fseek(fp, 0, SEEK_END);
+    *size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    buf = malloc(*size);
+    if (!buf || fread(buf, 1, *size, fp) != (size_t)*size)
+        fatal("can't read", name);
+    fclose(fp);
+    return buf;
+}
+
+/* Collect the absolute relocations of every SHT_REL section that applies
+   to an allocated section of the image. PC-relative relocations need no
+   fixup, since the whole image moves as a block. */
+
+void collect_relocs(unsigned int image_size)
+{
+    int i, j, n;
+    Elf32_Rel *rel;
+    Elf32_Sym *symtab;
+    Elf32_Sym *sym;
+
+    for (i = 0; i < ehdr->e_shnum; i++) {
+        if (shdr[i].sh_type == SHT_RELA)
+            fatal("RELA relocations are not supported", strtab + shdr[i].sh_name);
+        if (shdr[i].sh_type != SHT_REL)
+            continue;
+        if (!(shdr[shdr[i].sh_info].sh_flags & SHF_ALLOC))
+            continue;
+
+        rel = (Elf32_Rel *)(elf + shdr[i].sh_offset);
+        symtab = (Elf32_Sym *)(elf + shdr[shdr[i].sh_link].sh_offset);
+        n = shdr[i].sh_size / sizeof(Elf32_Rel);
+
+        for (j = 0; j < n; j++) {
+            sym = &symtab[ELF32_R_SYM(rel[j].r_info)];
+
+            /* Absolute symbols (e.g. fixed kernel addresses) don't move. */
+
+            if (ELF32_R_SYM(rel[j].r_info) && sym->st_shndx == SHN_ABS)
+                continue;
+            if (ELF32_R_SYM(rel[j].r_info) && sym->st_shndx == SHN_UNDEF)
+                fatal("undefined symbol in relocation", strtab + shdr[i].sh_name);
+
+            switch (ELF32_R_TYPE(rel[j].r_info)) {
+            case R_386_PC32:
+            case R_386_PC16:
+            case R_386_NONE:
+                break;
+            case R_386_32:
+                if (rel[j].r_offset + 4 > image_size || n32 == MAX_RELOCS)
+                    fatal("bad 32-bit relocation", strtab + shdr[i].sh_name);
+                reloc32[n32++] = rel[j].r_offset;
+                break;
+            case R_386_16:
+                if (rel[j].r_offset + 2 > image_size || n16 == MAX_RELOCS)
+                    fatal("bad 16-bit relocation", strtab + shdr[i].sh_name);
+                reloc16[n16++] = rel[j].r_offset;
+                break;
+            default:
+                fatal("unsupported relocation type in", strtab + shdr[i].sh_name);
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int opt;
+    long size;
+    unsigned int text_end, data_end, bss_end;
+    unsigned int stack_size = EXE_STACK_SIZE;
+    unsigned int flags = 0;
+    Elf32_Shdr *text, *data, *bss;
+    struct exe_header_t header;
+    unsigned char *image;
+    FILE *fp;
+
+    while ((opt = getopt(argc, argv, "s:m:")) != -1) {
+        switch (opt) {
+        case 's':
+            stack_size = strtoul(optarg, NULL, 0);
+            break;
+        case 'm':
+            if (!strcmp(optarg, "32"))
+                flags |= EXE_FLAG_32;
+            else if (strcmp(optarg, "16"))
+                fatal("mode must be 16 or 32", optarg);
+            break;
+        default:
+            fatal("usage: mkexe [-s stack-size] [-m 16|32] <program.elf> <program.bin>", NULL);
+        }
+    }
+    if (argc - optind != 2)
+        fatal("usage: mkexe [-s stack-size] [-m 16|32] <program.elf> <program.bin>", NULL);
+
+    /* Load and check the ELF file. */
+
+    elf = slurp(argv[optind], &size);
+    ehdr = (Elf32_Ehdr *)elf;
+
+    if (size < (long)sizeof(Elf32_Ehdr) || memcmp(ehdr->e_ident, ELFMAG, SELFMAG) ||
+        ehdr->e_ident[EI_CLASS] != ELFCLASS32 || ehdr->e_machine != EM_386)
+        fatal("not an i386 ELF file", argv[optind]);
+    if (ehdr->e_type != ET_EXEC)
+        fatal("not a linked executable", argv[optind]);
+
+    shdr = (Elf32_Shdr *)(elf + ehdr->e_shoff);
+    strtab = (const char *)(elf + shdr[ehdr->e_shstrndx].sh_offset);
+
+    /* Sections are laid out by prog.ld as .text, .data, .bss from address 0. */
+
+    text = section(".text");
+    data = section(".data");
+    bss = section(".bss");
+
+    if (!text || text->sh_addr != 0)
+        fatal("program must be linked at address 0 (see prog.ld)", argv[optind]);
+
+    text_end = data ? data->sh_addr : text->sh_size;
+    data_end = data ? data->sh_addr + data->sh_size : text_end;
+    bss_end = bss ? bss->sh_addr + bss->sh_size : data_end;
+
+    if (text_end < text->sh_size || bss_end < data_end)
+        fatal("unexpected section layout", argv[optind]);
+
+    if (bss_end + stack_size > 0xffff)
+        fatal("program too large", argv[optind]);
+
+    if (ehdr->e_entry >= text_end)
+        fatal("entry point is not in text", argv[optind]);
+
+    /* Flatten text and data into the image (gaps are zero-filled). */
+
+    image = calloc(1, data_end ? data_end : 1);
+    memcpy(image, elf + text->sh_offset, text->sh_size);
+    if (data && data->sh_size)
+        memcpy(image + data->sh_addr, elf + data->sh_offset, data->sh_size);
+
+    collect_relocs(data_end);
+
+    /* Fill in the header. */
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.signature, EXE_SIGNATURE, EXE_SIGLEN);
+    header.version = EXE_VERSION;
+    header.header_size = sizeof(header);
+    header.entry = ehdr->e_entry;
+    header.text_size = text_end;
+    header.data_size = data_end - text_end;
+    header.bss_size = bss_end - data_end;
+    header.stack_size = stack_size;
+    header.reloc32_count = n32;
+    header.reloc16_count = n16;
+    header.rt_version = symbol("__rt_version"); /* Defined by librt.a. */
+    header.flags = flags;
+
+    /* Write the executable. */
+
+    fp = fopen(argv[optind + 1], "w");
+    if (!fp)
+        fatal("can't create", argv[optind + 1]);
+
+    fwrite(&header, sizeof(header), 1, fp);
+    fwrite(image, 1, data_end, fp);
+    fwrite(reloc32, sizeof(reloc32[0]), n32, fp);
+    fwrite(reloc16, sizeof(reloc16[0]), n16, fp);
+
+    if (ferror(fp) || fclose(fp))
+        fatal("can't write", argv[optind + 1]);
+
+    printf("%s: text %u, data %u, bss %u, stack %u, relocs %d+%d, runtime %u%s\n",
+           argv[optind + 1], header.text_size, header.data_size, header.bss_size,
+           header.stack_size, n32, n16, header.rt_version, flags & EXE_FLAG_32 ? ", 32-bit" : "");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,73 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+/* Protected-mode kernel (make pm).
+
+   In this build variant the bootloader still runs in real mode, loads the
+   kernel and then calls pm_start() instead of kmain(). pm_start switches
+   the CPU to 32-bit protected mode with flat 4 GiB code and data segments,
+   sets up the interrupts and calls kmain(); from then on, the kernel and
+   the programs are 32-bit code.
+
+   The BIOS is gone by then, so the functions of bios1.h and bios2.h are
+   replaced by native drivers (pmdrv.c) for the console (video RAM), the
+   keyboard (8042 controller, polled) and the timer (8254 PIT on IRQ 0).
+   The only BIOS service still used is the disk, through bios_int(), which
+   drops back to real mode for the duration of the call. */
+
+#ifndef PM_H
+#define PM_H
+
+/* Segment selectors (see the GDT in pm.S). */
+
+#define PM_CODE32 0x08
+#define PM_DATA32 0x10
+
+/* Interrupt vectors. The PIC is remapped past the CPU exceptions (0-31) and
+   past the syscall vector (0x21), which stays where real-mode programs had
+   it. */
+
+#define PM_IRQ_BASE 0x28      /* IRQ 0-7 (master PIC).       */
+#define PM_IRQ_SLAVE_BASE 0x30 /* IRQ 8-15 (slave PIC).       */
+#define PM_SYSCALL 0x21       /* Syscall gate.               */
+
+#define PIT_HZ 1000 /* Timer frequency: 1 tick per millisecond. */
+
+/* Registers passed to and returned by a real-mode BIOS service. */
+
+struct bios_regs_t {
+    unsigned short ax, bx, cx, dx; /* General purpose registers.      */
+    unsigned short es;             /* Segment of buffers (es:bx).     */
+    unsigned short flags;          /* FLAGS after the call (CF = 1).  */
+} __attribute__((packed));
+
+/* pm.S */
+
+void pm_start(void); /* Enter protected mode and call kmain(). */
+int __attribute__((fastcall)) bios_int(int n, struct bios_regs_t *regs);
+void syscall_handler(void);
+void irq_timer(void);
+void irq_spurious(void);
+extern void *exception_table[32];
+
+/* pmdrv.c */
+
+extern volatile unsigned int ticks; /* Timer ticks since boot (PIT_HZ).  */
+
+void pm_init(void);
+void pm_exception(int vector);
+void idt_set(int vector, void *handler);
+void pic_bios(void);
+void pic_tydos(void);
+
+#endif /* PM_H  */
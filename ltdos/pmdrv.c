@@ -0,0 +1,262 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+/* This source file implements the native drivers of the protected-mode
+   kernel (see pm.h): interrupt setup, console, keyboard and timer. The
+   console and keyboard functions keep the interface (and behavior) of the
+   BIOS-based ones of the BIOS runtime (see ../biosrt/README), so the rest
+   of the kernel is the same in both builds. */
+
+#include "pm.h"    /* Protected-mode definitions. */
+#include "bios1.h" /* Console interface.          */
+#include "bios2.h" /* Keyboard, delay interface.  */
+#include "kaux.h"  /* For ROWS, COLS, inb() etc.  */
+#include "mem.h"   /* For memmove(), memsetw().   */
+
+/* Interrupts. */
+
+struct idt_entry_t {
+    unsigned short offset_low;  /* Handler address, bits 0-15.       */
+    unsigned short selector;    /* Code segment.                     */
+    unsigned char zero;         /* Reserved.                         */
+    unsigned char type;         /* Present, 32-bit interrupt gate.   */
+    unsigned short offset_high; /* Handler address, bits 16-31.      */
+} __attribute__((packed));
+
+/* Vectors above the slave PIC's are never used, so the table ends there. */
+
+struct idt_entry_t idt[PM_IRQ_SLAVE_BASE + 8];
+
+struct {
+    unsigned short limit;
+    unsigned int base;
+} __attribute__((packed)) idt_descriptor = {sizeof(idt) - 1, (unsigned int)idt};
+
+void idt_set(int vector, void *handler)
+{
+    idt[vector].offset_low = (unsigned int)handler & 0xffff;
+    idt[vector].selector = PM_CODE32;
+    idt[vector].zero = 0;
+    idt[vector].type = 0x8e;
+    idt[vector].offset_high = (unsigned int)handler >> 16;
+}
+
+void register_syscall_handler() { idt_set(PM_SYSCALL, syscall_handler); }
+
+void pm_exception(int vector)
+{
+    char str[12];
+
+    kwrite("\nCPU exception ");
+    uint_to_string(vector, str);
+    kwrite(str);
+    fatal("\n");
+}
+
+/* Programmable interrupt controllers (8259A). Outside BIOS calls, only the
+   timer (IRQ 0) is enabled; the keyboard is polled. */
+
+static unsigned char bios_pic_masks[2]; /* As left by the BIOS. */
+
+static void pic_remap(unsigned char master, unsigned char slave, unsigned char master_mask,
+                      unsigned char slave_mask)
+{
+    outb(0x20, 0x11); /* ICW1: initialize, ICW4 follows.  */
+    outb(0xa0, 0x11);
+    outb(0x21, master); /* ICW2: vector base.             */
+    outb(0xa1, slave);
+    outb(0x21, 0x04); /* ICW3: slave on IRQ 2.           */
+    outb(0xa1, 0x02);
+    outb(0x21, 0x01); /* ICW4: 8086 mode.                */
+    outb(0xa1, 0x01);
+    outb(0x21, master_mask); /* OCW1: masks.              */
+    outb(0xa1, slave_mask);
+}
+
+void pic_bios(void) { pic_remap(0x08, 0x70, bios_pic_masks[0], bios_pic_masks[1]); }
+void pic_tydos(void) { pic_remap(PM_IRQ_BASE, PM_IRQ_SLAVE_BASE, 0xfe, 0xff); }
+
+/* Timer (8254 PIT, channel 0). */
+
+volatile unsigned int ticks;
+
+/* Delay 't' milliseconds. */
+
+void __attribute__((fastcall)) udelay(unsigned short t)
+{
+    unsigned int start = ticks;
+
+    while (ticks - start < t * (PIT_HZ / 1000))
+        __asm__ volatile("hlt");
+}
+
+/* Console (text-mode video RAM). Characters are written with the
+   attribute already in the cell, like the BIOS teletype service. */
+
+static short (*const screen)[COLS] = (short (*)[COLS])0xb8000;
+static int cursor_row, cursor_col;
+
+static void console_cursor(void)
+{
+    unsigned int pos = cursor_row * COLS + cursor_col;
+
+    outb(0x3d4, 0x0f); /* CRT controller: cursor location. */
+    outb(0x3d5, pos & 0xff);
+    outb(0x3d4, 0x0e);
+    outb(0x3d5, pos >> 8);
+}
+
+static void console_putc(char c)
+{
+    switch (c) {
+    case '\n':
+        cursor_row++;
+        cursor_col = 0; /* LF implies CR (as in ../biosrt/kwrite.S). */
+        break;
+    case '\r':
+        cursor_col = 0;
+        break;
+    case '\b':
+        if (cursor_col)
+            cursor_col--;
+        break;
+    default:
+        screen[cursor_row][cursor_col] = (screen[cursor_row][cursor_col] & 0xff00) | (unsigned char)c;
+        if (++cursor_col == COLS) {
+            cursor_col = 0;
+            cursor_row++;
+        }
+    }
+
+    if (cursor_row == ROWS) { /* Scroll up one line. */
+        memmove(screen[0], screen[1], (ROWS - 1) * COLS * sizeof(short));
+        memsetw(screen[ROWS - 1], 0x0700 | ' ', COLS);
+        cursor_row = ROWS - 1;
+    }
+}
+
+void __attribute__((fastcall)) kwrite(const char *str)
+{
+    while (*str)
+        console_putc(*str++);
+    console_cursor();
+}
+
+void __attribute__((fastcall)) clear(void)
+{
+    memsetw(screen, 0x0700 | ' ', ROWS * COLS);
+    cursor_row = cursor_col = 0;
+    console_cursor();
+}
+
+void __attribute__((fastcall)) set_cursor(char row, char col)
+{
+    cursor_row = row;
+    cursor_col = col;
+    console_cursor();
+}
+
+void __attribute__((fastcall)) fatal(const char *msg)
+{
+    kwrite("Fatal error: ");
+    kwrite(msg);
+    halt();
+}
+
+/* Keyboard (8042 controller, scan code set 1). */
+
+static const char keymap[] = "\0\0331234567890-=\b\tqwertyuiop[]\r\0asdfghjkl;'`\0\\zxcvbnm,./\0*\0 ";
+static const char keymap_shift[] =
+    "\0\033!@#$%^&*()_+\b\tQWERTYUIOP{}\r\0ASDFGHJKL:\"~\0|ZXCVBNM<>?\0*\0 ";
+
+/* Wait for a key press and return its ASCII code. Characters received
+   on the serial port count as key presses (see serial_getc in kaux.c). */
+
+static char kbd_getc(void)
+{
+    static int shift;
+    unsigned char code;
+    int c;
+
+    while (1) {
+        while (!(inb(0x64) & 1)) { /* Output buffer empty:            */
+            if ((c = serial_getc()) >= 0)
+                return c;
+            __asm__ volatile("hlt"); /* wait a tick.                  */
+        }
+        code = inb(0x60);
+
+        if (code == 0x2a || code == 0x36) /* Shift pressed.  */
+            shift = 1;
+        else if (code == 0xaa || code == 0xb6) /* Shift released. */
+            shift = 0;
+        else if (code < sizeof(keymap) - 1 && keymap[code])
+            return shift ? keymap_shift[code] : keymap[code];
+    }
+}
+
+/* Read a line from the keyboard into 'buffer', echoing it, exactly like
+   the fast kread of the BIOS runtime: the line ends with Enter, Backspace
+   erases, and at most 'size' - 1 characters are kept. Return the number
+   of bytes read. */
+
+int __attribute__((fastcall)) kread(char *buffer, int size)
+{
+    int i = 0;
+    char c;
+    char echo[2] = {0, 0};
+
+    while ((c = kbd_getc()) != '\r') {
+        if (c == '\b') {
+            if (i > 0) {
+                i--;
+                kwrite("\b \b");
+            }
+            continue;
+        }
+        if (i == size - 1)
+            continue;
+        buffer[i++] = c;
+        echo[0] = c;
+        kwrite(echo);
+    }
+
+    kwrite("\n");
+    buffer[i] = 0;
+    return i;
+}
+
+/* Set up the machine right after the switch to protected mode. */
+
+void pm_init(void)
+{
+    int i;
+    unsigned int divisor = 1193182 / PIT_HZ;
+
+    for (i = 0; i < 32; i++)
+        idt_set(i, exception_table[i]);
+    idt_set(PM_IRQ_BASE, irq_timer);
+    idt_set(PM_IRQ_BASE + 7, irq_spurious);
+    __asm__ volatile("lidt idt_descriptor");
+
+    bios_pic_masks[0] = inb(0x21);
+    bios_pic_masks[1] = inb(0xa1);
+    pic_tydos();
+
+    outb(0x43, 0x36); /* Channel 0, lo/hi byte, square wave. */
+    outb(0x40, divisor & 0xff);
+    outb(0x40, divisor >> 8);
+
+    cursor_col = *(unsigned char *)0x450; /* Where the BIOS left the cursor. */
+    cursor_row = *(unsigned char *)0x451;
+}
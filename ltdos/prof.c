@@ -0,0 +1,135 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+
+/* This source file implements the sampling profiler (see prof.h); the
+   sampling itself is done by the timer interrupt handlers. */
+
+#include "prof.h"
+#include "kaux.h" /* For outb(), serial_puts(). */
+#include "mem.h"  /* For memset().             */
+
+unsigned char prof_enabled;
+unsigned char prof_running;        /* Sampling (checked by pm.S).      */
+unsigned int prof_base;            /* Program load address,            */
+unsigned int prof_size;            /* and size of the sampled area.    */
+unsigned int prof_samples;
+unsigned int prof_program;
+unsigned int prof_kernel;
+unsigned int prof_bios;
+unsigned int prof_buckets;
+unsigned short prof_chain_count;   /* Ticks until the BIOS's next one. */
+unsigned int prof_old_vector;      /* BIOS IRQ0 handler (segment:offset). */
+char prof_name[32];
+
+#ifndef TYDOS_PM
+extern char prof_tick[]; /* IRQ0 hook (bios2.S). */
+
+#define IRQ0_VECTOR ((unsigned int *)(0x08 * 4)) /* In the IVT. */
+
+/* Program PIT channel 0 to interrupt at 1193182 / 'divisor' Hz. */
+
+static void pit_set(unsigned int divisor)
+{
+    outb(0x43, 0x36); /* Channel 0, lo/hi byte, square wave. */
+    outb(0x40, divisor & 0xff);
+    outb(0x40, divisor >> 8);
+}
+#endif
+
+/* Start sampling the program 'name', loaded between 'base' and 'end'. */
+
+void prof_start(const char *name, char *base, char *end)
+{
+    if (!prof_enabled)
+        return;
+
+    prof_base = (unsigned int)base;
+    prof_size = end - base;
+    prof_buckets = (prof_size + PROF_GRAIN - 1) >> PROF_SHIFT;
+    prof_samples = prof_program = prof_kernel = prof_bios = 0;
+    memset(_PROF_HIST, 0, prof_buckets * sizeof(_PROF_HIST[0]));
+    memcpy(prof_name, name, sizeof(prof_name) - 1);
+
+#ifdef TYDOS_PM
+    prof_running = 1;
+#else
+    __asm__ volatile("cli");
+    prof_old_vector = *IRQ0_VECTOR;
+    *IRQ0_VECTOR = (unsigned int)prof_tick; /* Segment 0. */
+    prof_chain_count = PROF_CHAIN;
+    pit_set(1193182 / PROF_HZ);
+    prof_running = 1;
+    __asm__ volatile("sti");
+#endif
+}
+
+/* Stop sampling, and give the timer back to the BIOS. */
+
+void prof_stop(void)
+{
+    if (!prof_running)
+        return;
+
+#ifdef TYDOS_PM
+    prof_running = 0;
+#else
+    __asm__ volatile("cli");
+    pit_set(0); /* 65536: the BIOS's 18.2 Hz. */
+    *IRQ0_VECTOR = prof_old_vector;
+    prof_running = 0;
+    __asm__ volatile("sti");
+#endif
+}
+
+/* Write 'n' in hexadecimal to the serial port. */
+
+static void serial_hex(unsigned int n)
+{
+    char str[9];
+
+    uint_to_hex(n, str, 0);
+    serial_puts(str);
+}
+
+/* Write the last profile to the serial port (see the format in prof.h). */
+
+void prof_dump(void)
+{
+    unsigned int i;
+
+    serial_puts("TyPF ");
+    serial_puts(prof_name[0] ? prof_name : "-");
+    serial_puts(" ");
+    serial_hex(prof_samples);
+    serial_puts(" ");
+    serial_hex(prof_program);
+    serial_puts(" ");
+    serial_hex(prof_kernel);
+    serial_puts(" ");
+    serial_hex(prof_bios);
+    serial_puts(" ");
+    serial_hex(PROF_GRAIN);
+    serial_puts("\r\n");
+
+    for (i = 0; i < prof_buckets; i++) {
+        if (!_PROF_HIST[i])
+            continue;
+        serial_hex(i << PROF_SHIFT);
+        serial_puts(" ");
+        serial_hex(_PROF_HIST[i]);
+        serial_puts("\r\n");
+    }
+
+    serial_puts("end\r\n");
+}
@@ -0,0 +1,65 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+
+/* Sampling profiler for user programs.
+
+   When armed ('prof on'), the kernel samples the interrupted instruction
+   pointer at every timer tick while a program runs, and counts the samples
+   in a histogram of PROF_GRAIN-byte buckets covering the program area
+   (_PROF_HIST in tydos.ld). Samples outside the program are only counted,
+   as kernel (the runtime and syscalls, below 64 KiB) or BIOS time.
+
+   In the real-mode kernel the timer is reprogrammed to PROF_HZ for the run
+   and IRQ0 is hooked (prof_tick in bios2.S), chaining to the BIOS handler
+   every PROF_CHAIN ticks so that the time of day keeps going. The
+   protected-mode kernel samples from its own timer handler (pm.S), which
+   already runs at PIT_HZ.
+
+   Bucket offsets are relative to the program's load address, which is the
+   address the program was linked at (0, see prog.ld) plus the base, so they
+   are plain addresses in the program's ELF file and in its link map.
+
+   'prof dump' writes the last profile to the serial port as
+
+      TyPF <program> <samples> <in the program> <kernel> <bios> <grain>
+      <offset> <samples>       (non-empty buckets only)
+      ...
+      end
+
+   with the numbers in hexadecimal, which the host tool typrof attributes
+   to functions. */
+
+#ifndef PROF_H
+#define PROF_H
+
+#define PROF_SHIFT 5                /* Bucket size: 32 bytes (see pm.S, bios2.S). */
+#define PROF_GRAIN (1 << PROF_SHIFT)
+#define PROF_HZ 1000                /* Sampling rate in real mode.                */
+#define PROF_CHAIN 55               /* 1193182 / 65536 Hz is 1/55 of PROF_HZ.     */
+
+extern unsigned short _PROF_HIST[]; /* The histogram (tydos.ld).         */
+
+extern unsigned char prof_enabled;  /* Armed by 'prof on'.               */
+extern unsigned int prof_samples;   /* Samples in the last run.          */
+extern unsigned int prof_program;   /* Of which in the program,          */
+extern unsigned int prof_kernel;    /* in the kernel,                    */
+extern unsigned int prof_bios;      /* and in the BIOS.                  */
+extern unsigned int prof_buckets;   /* Buckets in use.                   */
+extern char prof_name[];            /* Program of the last run.          */
+
+void prof_start(const char *name, char *base, char *end);
+void prof_stop(void);
+void prof_dump(void);
+
+#endif /* PROF_H  */
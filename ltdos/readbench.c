@@ -0,0 +1,72 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+
+/* Measure sequential read throughput of a file (the command tail, or
+   READ_FILE), with a few read sizes. The file is read over and over from
+   the start, reopened at its end (see open() in tydos.h). */
+
+#include "bench.h"
+
+#define READ_FILE "sonnet_18.txt"
+#define SIZES 3
+
+static const unsigned int sizes[SIZES] = {64, 512, 4096};
+
+static const char *name;
+static int fd;
+static unsigned int size, bytes;
+char buffer[4096];
+
+/* Read the next block, reopening the file at its end. */
+
+static int read_block(void *arg)
+{
+    int n = read(fd, buffer, size);
+
+    if (!n) {
+        close(fd);
+        fd = open(name);
+        if (fd < 0)
+            return -1;
+        n = read(fd, buffer, size);
+    }
+    bytes += n;
+    return n;
+}
+
+int main()
+{
+    unsigned int ms;
+    int i;
+
+    name = PSP->tail_len ? PSP->tail : READ_FILE;
+
+    for (i = 0; i < SIZES; i++) {
+        fd = open(name);
+        if (fd < 0) {
+            puts("File not found.\n");
+            exit(1);
+        }
+        size = sizes[i];
+        bytes = 0;
+        bench_run(read_block, 0, 4, &ms);
+        close(fd);
+
+        puts("read ");
+        put_uint(size);
+        bench_report(" bytes", bytes / 1024, ms, "KiB");
+    }
+
+    return 0;
+}
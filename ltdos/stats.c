@@ -0,0 +1,91 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+
+/* This source file implements the kernel performance counters. */
+
+#include "stats.h"
+#include "mem.h"  /* For memset().           */
+#include "kaux.h" /* For rdtsc64(), inb().   */
+
+struct stat_t syscall_stats[SYS_COUNT];
+struct stat_t disk_stats;
+struct stat_t console_stats;
+
+/* Account an event of 'cycles' cycles and 'units' units of work. */
+
+void stats_add(struct stat_t *stat, unsigned int cycles, unsigned int units)
+{
+    if (!stat->count || cycles < stat->min)
+        stat->min = cycles;
+    if (cycles > stat->max)
+        stat->max = cycles;
+    stat->count++;
+    stat->units += units;
+    stat->total += cycles;
+}
+
+void __attribute__((fastcall)) stats_syscall(unsigned int number, unsigned int cycles)
+{
+    if (number < SYS_COUNT)
+        stats_add(&syscall_stats[number], cycles, 0);
+}
+
+/* Zero all the counters. */
+
+void stats_reset(void)
+{
+    memset(syscall_stats, 0, sizeof(syscall_stats));
+    memset(&disk_stats, 0, sizeof(disk_stats));
+    memset(&console_stats, 0, sizeof(console_stats));
+}
+
+/* Boot timeline. */
+
+unsigned long long boot_tsc[BOOT_STAGES];
+
+void boot_mark(int stage) { boot_tsc[stage] = rdtsc64(); }
+
+/* Return the rate of the time-stamp counter in kHz (cycles per ms), or 0
+   if it can't be measured. The counter is timed against 10 ms of the
+   PIT's channel 2, the speaker's, which nobody else uses and whose output
+   can be polled at port 0x61. We give up after 2^30 cycles, in case there
+   is no PIT (some emulators). The result is measured once and kept. */
+
+#define PIT_CLOCK 1193182 /* PIT input clock, in Hz. */
+
+unsigned int tsc_khz(void)
+{
+    static unsigned int khz;
+    unsigned int start, cycles;
+    unsigned char gate;
+
+    if (khz)
+        return khz;
+
+    gate = inb(0x61);
+    outb(0x61, (gate & ~0x02) | 0x01); /* Speaker off, channel 2 gate on. */
+    outb(0x43, 0xb0);                  /* Channel 2, lo/hi byte, mode 0.  */
+    outb(0x42, (PIT_CLOCK / 100) & 0xff);
+    outb(0x42, (PIT_CLOCK / 100) >> 8);
+
+    start = rdtsc32();
+    do
+        cycles = rdtsc32() - start;
+    while (!(inb(0x61) & 0x20) && cycles < 0x40000000); /* Until it counts down. */
+
+    outb(0x61, gate);
+    if (cycles < 0x40000000)
+        khz = cycles / 10;
+    return khz;
+}
@@ -0,0 +1,72 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+
+/* Kernel performance counters.
+
+   Each counter accumulates the number of events, their total, minimum and
+   maximum duration in CPU cycles (rdtsc), and a count of units of work
+   (sectors read, bytes written...) where that makes sense. They are shown
+   and reset by the shell's 'stats' and 'resetstats' built-ins. */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include "tydos.h" /* For SYS_COUNT. */
+
+struct stat_t {
+    unsigned int count;       /* Number of events.                  */
+    unsigned int units;       /* Units of work, e.g. sectors.       */
+    unsigned int min;         /* Shortest event, in cycles.         */
+    unsigned int max;         /* Longest event, in cycles.          */
+    unsigned long long total; /* All events, in cycles.             */
+};
+
+extern struct stat_t syscall_stats[SYS_COUNT]; /* Per syscall number.   */
+extern struct stat_t disk_stats;               /* load_disk(): sectors. */
+extern struct stat_t console_stats;            /* sys_write(): bytes.   */
+
+/* console_stats counts what programs write (puts() and the like all end
+   in sys_write), not what the kernel writes itself with kwrite(): the
+   shell's prompt, echo and built-ins, 'stats' included, are left out. */
+
+void stats_add(struct stat_t *stat, unsigned int cycles, unsigned int units);
+void stats_reset(void);
+
+/* Called by the syscall handler (bios2.S, pm.S) after each syscall. */
+
+void __attribute__((fastcall)) stats_syscall(unsigned int number, unsigned int cycles);
+
+/* Boot timeline. rt0.S saves the time-stamp counter at _BOOT_TSC as soon
+   as it has a stack, and boot_mark() records when each stage ends; the
+   shell's 'boottime' built-in shows their durations. Stage-1 load runs
+   up to kmain() (including the switch to protected mode in 'make pm'),
+   and shell init ends right before the first prompt. */
+
+#define BOOT_LOAD 0    /* Boot sector, kernel load.            */
+#define BOOT_KERNEL 1  /* Kernel data structures.              */
+#define BOOT_SYSCALL 2 /* Syscall handler registration.        */
+#define BOOT_SPLASH 3  /* Splash screen (see FASTBOOT).        */
+#define BOOT_SHELL 4   /* Shell, up to the first prompt.       */
+#define BOOT_STAGES 5
+
+#define BOOT_NAMES {"stage-1 load", "kernel init", "syscalls", "splash", "shell init"}
+
+extern unsigned long long _BOOT_TSC;            /* From the linker script. */
+extern unsigned long long boot_tsc[BOOT_STAGES]; /* End of each stage.     */
+
+void boot_mark(int stage);
+
+unsigned int tsc_khz(void);
+
+#endif /* STATS_H  */
@@ -0,0 +1,30 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+
+/* Measure the rate of null syscalls, i.e. the bare cost of entering and
+   leaving the kernel through int $0x21, with its accounting. */
+
+#include "bench.h"
+
+static int null_call(void *arg) { return nop(); }
+
+int main()
+{
+    unsigned int calls, ms;
+
+    calls = bench_run(null_call, 0, 100, &ms);
+    bench_report("null syscall", calls, ms, "calls");
+
+    return 0;
+}
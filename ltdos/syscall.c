@@ -15,6 +15,11 @@
 
 #include "bios1.h"
 #include "bios2.h"
+#include "fs.h"     /* Files.         */
+#include "kaux.h"   /* For rdtsc32(). */
+#include "mem.h"    /* For strlen().  */
+#include "stats.h"  /* Console counters. */
+#include "trace.h"  /* Keyboard waits.   */
 
 /* TyDOS syscall calling convetion: arguments in %ax, %dx and %cx.
    return value in %ax. See regparm(3) in function attributes section
@@ -26,10 +31,27 @@
 
 int _tycall_ sys_write(const char* str)
 {
+  unsigned int start = rdtsc32 ();
   kwrite (str);
+  stats_add (&console_stats, rdtsc32 () - start, strlen (str));
   return 0;
 }
 
+/* Read a line from the keyboard into 'str', a buffer of 'size' bytes.
+   Size 0 stands for the 11 bytes that gets() always assumed. */
+
+#define GETS_SIZE 11
+
+int _tycall_ sys_gets(char* str, int size)
+{
+  int length;
+
+  TRACE (TRACE_KBD_WAIT, 0, 0, 0);
+  length = kread (str, size ? size : GETS_SIZE);
+  TRACE (TRACE_KBD_DONE, 0, length, 0);
+  return length;
+}
+
 /*  Syscall 0 is invalid (should never be called)*/
 
 int _tycall_ sys_invalid ()
@@ -39,9 +61,60 @@ int _tycall_ sys_invalid ()
 }
 
 
-/* This syscall should be called by the program upon termination. */
+/* Terminate the program, returning 'status' to the shell (just like
+   returning from main). */
+
+int _tycall_ sys_exit(int status)
+{
+  exec_exit (status);
+  return 0;
+}
+
+/* Do nothing. Programs time this to measure the cost of a syscall. */
 
-int _tycall_ sys_exit()
+int _tycall_ sys_null ()
 {
   return 0;
 }
+
+/* Return a millisecond clock (see uptime). */
+
+int _tycall_ sys_clock ()
+{
+  return uptime ();
+}
+
+/* Open file 'name' for reading, returning a descriptor or -1. */
+
+int _tycall_ sys_open(const char *name)
+{
+  return fs_open (name);
+}
+
+/* Read up to 'size' bytes of file 'fd' into 'buffer' (see fs.h). */
+
+int _tycall_ sys_read(int fd, char *buffer, unsigned int size)
+{
+  return fs_read (fd, buffer, size);
+}
+
+int _tycall_ sys_close(int fd)
+{
+  return fs_close (fd);
+}
+
+/* The syscall table, indexed by syscall number (see tydos.h). The
+   interrupt handler (bios2.S or pm.S) calls the entry selected by %bx. */
+
+void *syscall_table[] =
+  {
+    sys_invalid,		/* Syscall 0: invalid.   */
+    sys_exit,			/* Syscall 1: exit.      */
+    sys_write,			/* Syscall 2: write      */
+    sys_gets,			/* Syscall 3: gets       */
+    sys_null,			/* Syscall 4: null       */
+    sys_clock,			/* Syscall 5: clock      */
+    sys_open,			/* Syscall 6: open       */
+    sys_read,			/* Syscall 7: read       */
+    sys_close			/* Syscall 8: close      */
+  };
@@ -1,8 +1,8 @@
 /*
- *    SPDX-FileCopyrightText: 2021 Monaco F. J. <monaco@usp.br>
  *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
  *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
- *   
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
  *    SPDX-License-Identifier: GPL-3.0-or-later
  *
  *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
@@ -11,9 +11,20 @@
  *  Tiago Oliva <tiago.oliva.costa@gmail.com>
  */
 
-#ifndef OPT_H
-#define OPT_H
 
-int __attribute__((fastcall)) strcmp(const char *s1, const char *s2);
+/* Issue a fixed number of cheap syscalls (writes of an empty string), the
+   syscall-loop workload of 'make bench'. */
+
+#include "tydos.h"
+
+#define SYSLOOP_COUNT 1000
+
+int main()
+{
+    int i;
+
+    for (i = 0; i < SYSLOOP_COUNT; i++)
+        puts("");
 
-#endif
+    return 0;
+}
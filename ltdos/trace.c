@@ -0,0 +1,85 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+
+/* This source file implements the kernel event trace (see trace.h). */
+
+#include "trace.h"
+#include "kaux.h" /* For serial_puts().  */
+#include "mem.h"  /* For memset().       */
+
+extern struct trace_event_t _TRACE_RING[TRACE_SIZE]; /* See tydos.ld. */
+
+unsigned char trace_enabled;
+unsigned int trace_count;
+
+/* Record an event in the ring, overwriting the oldest one if it is full. */
+
+void trace_event(int type, int status, int arg, unsigned int value)
+{
+    struct trace_event_t *event = &_TRACE_RING[trace_count++ & (TRACE_SIZE - 1)];
+
+    __asm__ volatile("rdtsc" : "=A"(event->tsc));
+    event->type = type;
+    event->status = status;
+    event->arg = arg;
+    event->value = value;
+}
+
+/* Called by the syscall handler (bios2.S, pm.S) when tracing is on. */
+
+void __attribute__((fastcall)) trace_syscall(unsigned int number, int type)
+{
+    trace_event(type, 0, number, 0);
+}
+
+void trace_clear(void)
+{
+    trace_count = 0;
+    memset(_TRACE_RING, 0, sizeof(_TRACE_RING));
+}
+
+unsigned int trace_length(void)
+{
+    return trace_count < TRACE_SIZE ? trace_count : TRACE_SIZE;
+}
+
+struct trace_event_t *trace_get(unsigned int n)
+{
+    return &_TRACE_RING[(trace_count - trace_length() + n) & (TRACE_SIZE - 1)];
+}
+
+/* Write the ring to the serial port (see the format in trace.h). */
+
+void trace_dump(void)
+{
+    unsigned char *p;
+    unsigned int i, j, n = trace_length();
+    char str[12];
+
+    serial_puts("TyTR ");
+    uint_to_string(n, str);
+    serial_puts(str);
+    serial_puts("\r\n");
+
+    for (i = 0; i < n; i++) {
+        p = (unsigned char *)trace_get(i);
+        for (j = 0; j < sizeof(struct trace_event_t); j++) {
+            uint_to_hex(p[j], str, 2);
+            serial_puts(str);
+        }
+        serial_puts("\r\n");
+    }
+
+    serial_puts("end\r\n");
+}
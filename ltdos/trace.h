@@ -0,0 +1,85 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+
+/* Kernel event trace.
+
+   This header is shared by the kernel (trace.c) and by the host tool that
+   decodes trace dumps (tytrace.c), so it must compile both freestanding
+   and on the host.
+
+   When enabled (shell command 'trace on'), the kernel records timestamped
+   events in a ring of TRACE_SIZE entries at a fixed address below 64 KiB
+   (_TRACE_RING in tydos.ld), overwriting the oldest ones. The ring is
+   outside the kernel image, so it costs nothing in the boot time, and with
+   tracing off each trace point is a single test of 'trace_enabled'.
+
+   'trace dump' writes the ring to the first serial port as text:
+
+      TyTR <number of events>
+      <32 hex digits: the bytes of one struct trace_event_t>
+      ...
+      end
+
+   oldest event first, which tytrace turns into a timeline. */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#define TRACE_SIZE 256 /* Events in the ring (a power of 2). */
+
+/* Event types, and the meaning of the 'arg', 'status' and 'value' fields. */
+
+#define TRACE_NONE 0         /* Unused entry.                                */
+#define TRACE_SYSCALL 1      /* Syscall entry: arg = number.                 */
+#define TRACE_SYSRET 2       /* Syscall exit: arg = number.                  */
+#define TRACE_DISK 3         /* Disk read: arg = sectors, value = LBA.       */
+#define TRACE_DISK_DONE 4    /* Disk read done: status = BIOS error code.    */
+#define TRACE_LOAD 5         /* Program load: value = offset in the disk.    */
+#define TRACE_LOAD_DONE 6    /* Program loaded: status = EXE_ERR_*.          */
+#define TRACE_KBD_WAIT 7     /* Waiting for a line from the keyboard.        */
+#define TRACE_KBD_DONE 8     /* Line read: arg = length.                     */
+#define TRACE_TYPES 9
+
+#define TRACE_NAMES                                                         \
+    {"none", "syscall", "sysret", "disk", "disk done", "load", "load done", \
+     "kbd wait", "kbd done"}
+
+struct trace_event_t {
+    unsigned long long tsc; /* CPU time-stamp counter.  */
+    unsigned char type;     /* TRACE_*.                 */
+    unsigned char status;   /* Result, if any.          */
+    unsigned short arg;     /* Small argument.          */
+    unsigned int value;     /* Large argument.          */
+} __attribute__((packed));  /* 16 bytes, as dumped.     */
+
+/* Kernel side (trace.c). */
+
+extern unsigned char trace_enabled; /* Record events (0: off).      */
+extern unsigned int trace_count;    /* Events recorded since reset. */
+
+void trace_event(int type, int status, int arg, unsigned int value);
+void trace_clear(void);
+struct trace_event_t *trace_get(unsigned int n); /* n-th oldest event. */
+unsigned int trace_length(void);                 /* Events in the ring. */
+void trace_dump(void);
+
+/* Trace points: nearly free when tracing is off. */
+
+#define TRACE(type, status, arg, value)            \
+    do {                                           \
+        if (trace_enabled)                         \
+            trace_event(type, status, arg, value); \
+    } while (0)
+
+#endif /* TRACE_H  */
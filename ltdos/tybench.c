@@ -0,0 +1,168 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+
+/* tybench - collect the results of 'make bench' and check them.
+
+   Usage: tybench [-t percent] <log> [baseline]
+
+   The log is the serial output of a TyDOS session, in which the 'time'
+   and 'boottime dump' built-ins write lines like
+
+      TyBM time 1234 exec hello.bin
+      TyBM boot 567 stage-1 load
+
+   with the results in thousands of cycles; any other text is ignored.
+   Each line becomes a metric, named after the kind and the rest of the
+   line with blanks as underscores (time.exec_hello.bin, boot.stage-1_load),
+   and the metrics are printed one per line as '<name> <kcycles>'. This is
+   also the format of the baseline (lines starting with '#' are comments),
+   so the output of a good run can be checked in as the next baseline.
+
+   With a baseline, every metric more than 'percent' (default 10) above
+   its baseline value is reported on stderr and tybench exits with status
+   1. Metrics missing from the baseline are only reported. If the
+   baseline has no metrics at all (none recorded yet), tybench says so
+   and skips the comparison.
+   This is a host program: it runs on the build machine, not on TyDOS. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_METRICS 256
+
+struct metric_t {
+    char name[64];
+    unsigned long value;
+};
+
+struct metric_t results[MAX_METRICS], baseline[MAX_METRICS];
+int n_results, n_baseline;
+
+void fatal(const char *msg, const char *arg)
+{
+    fprintf(stderr, "tybench: %s%s%s\n", msg, arg ? ": " : "", arg ? arg : "");
+    exit(EXIT_FAILURE);
+}
+
+void add_metric(struct metric_t *metrics, int *n, const char *name, unsigned long value)
+{
+    if (*n == MAX_METRICS)
+        fatal("too many metrics", NULL);
+    snprintf(metrics[*n].name, sizeof(metrics[0].name), "%s", name);
+    metrics[*n].value = value;
+    (*n)++;
+}
+
+struct metric_t *find_metric(struct metric_t *metrics, int n, const char *name)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        if (!strcmp(metrics[i].name, name))
+            return &metrics[i];
+    return NULL;
+}
+
+/* Read the TyBM lines of a session log. */
+
+void read_log(FILE *fp)
+{
+    char line[256], kind[16], what[128], name[64], *p;
+    unsigned long value;
+
+    while (fgets(line, sizeof(line), fp)) {
+        p = strstr(line, "TyBM ");
+        if (!p || sscanf(p, "TyBM %15s %lu %127[^\r\n]", kind, &value, what) != 3)
+            continue;
+        for (p = what; *p; p++)
+            if (*p == ' ' || *p == '\t')
+                *p = '_';
+        snprintf(name, sizeof(name), "%s.%.47s", kind, what);
+        add_metric(results, &n_results, name, value);
+    }
+}
+
+/* Read a baseline: '<name> <value>' lines and comments. */
+
+void read_baseline(FILE *fp)
+{
+    char line[256], name[64];
+    unsigned long value;
+
+    while (fgets(line, sizeof(line), fp)) {
+        if (line[0] == '#')
+            continue;
+        if (sscanf(line, "%63s %lu", name, &value) == 2)
+            add_metric(baseline, &n_baseline, name, value);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int opt, i, threshold = 10, regressions = 0;
+    struct metric_t *base;
+    FILE *fp;
+
+    while ((opt = getopt(argc, argv, "t:")) != -1) {
+        switch (opt) {
+        case 't':
+            threshold = atoi(optarg);
+            break;
+        default:
+            fatal("usage: tybench [-t percent] <log> [baseline]", NULL);
+        }
+    }
+    if (argc - optind < 1 || argc - optind > 2)
+        fatal("usage: tybench [-t percent] <log> [baseline]", NULL);
+
+    fp = fopen(argv[optind], "r");
+    if (!fp)
+        fatal("can't open", argv[optind]);
+    read_log(fp);
+    fclose(fp);
+    if (!n_results)
+        fatal("no results (TyBM) in the log", argv[optind]);
+
+    if (argc - optind == 2) {
+        fp = fopen(argv[optind + 1], "r");
+        if (!fp)
+            fatal("can't open", argv[optind + 1]);
+        read_baseline(fp);
+        fclose(fp);
+        if (!n_baseline)
+            fprintf(stderr, "tybench: %s: no baseline recorded, run 'make bench-baseline'\n",
+                    argv[optind + 1]);
+    }
+
+    printf("# TyDOS benchmark results, in thousands of cycles.\n");
+    for (i = 0; i < n_results; i++) {
+        printf("%s %lu\n", results[i].name, results[i].value);
+
+        if (argc - optind < 2 || !n_baseline)
+            continue;
+        base = find_metric(baseline, n_baseline, results[i].name);
+        if (!base)
+            fprintf(stderr, "tybench: %s: %lu (no baseline)\n", results[i].name,
+                    results[i].value);
+        else if (results[i].value * 100 > base->value * (100 + threshold)) {
+            fprintf(stderr, "tybench: %s: %lu, %lu in the baseline: regression\n",
+                    results[i].name, results[i].value, base->value);
+            regressions++;
+        }
+    }
+
+    return regressions ? EXIT_FAILURE : EXIT_SUCCESS;
+}
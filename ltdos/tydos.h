@@ -13,7 +13,8 @@
 
 /* Library libtydos.a should be statically linked against user programs meant
    for running on TyDOS. It provides some custom C functions that invoke system
-   calls for trivial tasks.
+   calls for trivial tasks. The kernel hosts a copy of it as well, which
+   programs linked against librt.a call instead (see rt.inc).
 
    This is the header file that should be included in the user programs. */
 
@@ -26,8 +27,53 @@
 #define SYS_EXIT 1
 #define SYS_WRITE 2
 #define SYS_GETS 3
+#define SYS_NULL 4
+#define SYS_CLOCK 5
+#define SYS_OPEN 6
+#define SYS_READ 7
+#define SYS_CLOSE 8
+#define SYS_COUNT 9 /* Number of syscalls. */
 
 void puts(const char *str); /* Outputs 'str' on the screen. */
 void gets(const char *str); /* Get 'str' input from the console. */
+void exit(int status);      /* Terminate with exit status 'status'. */
+
+int nop(void);              /* Do nothing (a syscall's bare cost).  */
+unsigned int clock(void);   /* Milliseconds; in real mode, in steps of 55. */
+
+/* Files. A file reads as long as the size its TyFS entry records, or as
+   its whole area on the volume if the entry records none (see fs.h). */
+
+int open(const char *name);                   /* Descriptor, or -1.    */
+int read(int fd, void *buf, unsigned int n);  /* Bytes read, 0 at end. */
+int close(int fd);
+
+/* The program segment prefix (PSP).
+
+   Before running a program, the shell fills in this block at a fixed
+   address with the program's file name and the command tail, i.e. the
+   rest of the command line after the name, with the leading blanks
+   removed. Programs read it in place, e.g. PSP->tail. */
+
+#define PSP_ADDR 0x0500     /* Below the program area (tydos.ld). */
+#define PSP_NAME_SIZE 32    /* As a directory entry.              */
+#define PSP_TAIL_SIZE 128
+
+struct psp_t {
+    char name[PSP_NAME_SIZE];  /* Program file name, NUL-terminated. */
+    unsigned short tail_len;   /* Length of the command tail.         */
+    char tail[PSP_TAIL_SIZE];  /* Command tail, NUL-terminated.       */
+} __attribute__((packed));
+
+#define PSP ((struct psp_t *)PSP_ADDR)
+
+/* Memory and string primitives (see mem.h). */
+
+void *memcpy(void *dst, const void *src, unsigned int n);
+void *memmove(void *dst, const void *src, unsigned int n);
+void *memset(void *dst, int c, unsigned int n);
+void *memsetw(void *dst, int w, unsigned int n);
+unsigned int strlen(const char *s);
+int strcmp(const char *s1, const char *s2);
 
 #endif /* TYDOS_H  */
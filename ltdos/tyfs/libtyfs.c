@@ -0,0 +1,179 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+/* This source file implements the TyFS layout (see tyfs.h). */
+
+#include "tyfs.h"
+
+#ifndef TYFS_READ_ONLY
+
+/* Complete a header whose total_number_of_sectors, number_of_boot_sectors
+ * and max_file_size are set: compute how many files the volume supports
+ * and the space left over, and write the signature. Return the number of
+ * entries (0 if not even one file fits), or -1 if the boot sectors or the
+ * file size make no sense for the volume.
+ * Arguments: <header>
+ */
+int tyfs_format(struct fs_header_t *header)
+{
+    unsigned int i, space;
+
+    if (header->number_of_boot_sectors < 1 || header->max_file_size < 1 ||
+        header->number_of_boot_sectors >= header->total_number_of_sectors)
+        return -1;
+
+    space = (unsigned int)(header->total_number_of_sectors - header->number_of_boot_sectors) *
+            SECTOR_SIZE;
+
+    header->number_of_file_entries = space / (DIR_ENTRY_LEN + tyfs_file_size(header));
+    header->unused_space = space - header->number_of_file_entries *
+                                       (DIR_ENTRY_LEN + tyfs_file_size(header));
+
+    for (i = 0; i < FS_SIGLEN; i++)
+        header->signature[i] = FS_SIGNATURE[i];
+
+    return header->number_of_file_entries;
+}
+
+/* Check that 'header' is that of a TyFS volume of 'sectors' sectors: it
+ * has the signature, and its directory and clusters fit in the volume.
+ * Return TYFS_OK, or the error (see tyfs.h). The check is done in sectors,
+ * so that a corrupt header does not overflow it.
+ * Arguments: <header> <volume-sectors>
+ */
+int tyfs_check(const struct fs_header_t *header, unsigned int sectors)
+{
+    unsigned int i;
+
+    for (i = 0; i < FS_SIGLEN; i++)
+        if (header->signature[i] != (unsigned char)FS_SIGNATURE[i])
+            return TYFS_ERR_SIGNATURE;
+
+    if (header->number_of_boot_sectors + tyfs_dir_sectors(header) +
+            (unsigned int)header->number_of_file_entries * header->max_file_size >
+        sectors)
+        return TYFS_ERR_LAYOUT;
+
+    return TYFS_OK;
+}
+
+#endif /* TYFS_READ_ONLY */
+
+/* Return the byte offset in the volume where the directory starts.
+ * Arguments: <header>
+ */
+unsigned int tyfs_dir_offset(const struct fs_header_t *header)
+{
+    return header->number_of_boot_sectors * SECTOR_SIZE;
+}
+
+/* Return the number of sectors the directory spans.
+ * Arguments: <header>
+ */
+unsigned int tyfs_dir_sectors(const struct fs_header_t *header)
+{
+    return (header->number_of_file_entries * DIR_ENTRY_LEN + SECTOR_SIZE - 1) / SECTOR_SIZE;
+}
+
+/* Return the byte offset in the volume where the cluster of 'slot' starts.
+ * Arguments: <header> <slot>
+ */
+unsigned int tyfs_slot_offset(const struct fs_header_t *header, int slot)
+{
+    return tyfs_dir_offset(header) + header->number_of_file_entries * DIR_ENTRY_LEN +
+           tyfs_file_size(header) * slot;
+}
+
+/* Return the size of a cluster, the largest a file can be, in bytes.
+ * Arguments: <header>
+ */
+unsigned int tyfs_file_size(const struct fs_header_t *header)
+{
+    return (unsigned int)header->max_file_size * SECTOR_SIZE;
+}
+
+/* Return the entry of 'slot' in 'directory'.
+ * Arguments: <directory> <slot>
+ */
+struct fs_entry_t *tyfs_entry(char *directory, int slot)
+{
+    return (struct fs_entry_t *)(directory + slot * DIR_ENTRY_LEN);
+}
+
+/* Return the size recorded for the file in 'entry', or -1 if none is.
+ * Volumes made before sizes had 32-byte names: there, a name of 24 or
+ * more characters runs over 'size' and 'crc', so an entry whose name does
+ * not end within FS_NAME_LEN, or whose size can't be, has none either.
+ * Arguments: <header> <entry>
+ */
+int tyfs_entry_size(const struct fs_header_t *header, const struct fs_entry_t *entry)
+{
+    unsigned int size = entry->size & ~FS_SIZE_RECORDED;
+
+    if (!(entry->size & FS_SIZE_RECORDED) || entry->name[FS_NAME_LEN - 1] ||
+        size > tyfs_file_size(header))
+        return -1;
+
+    return size;
+}
+
+/* Return the first slot after 'slot' that holds a file, or -1 if none
+ * does; start with a 'slot' of -1 to go through all the files.
+ * Arguments: <header> <directory> <slot>
+ */
+int tyfs_next(const struct fs_header_t *header, const char *directory, int slot)
+{
+    while (++slot < header->number_of_file_entries)
+        if (directory[slot * DIR_ENTRY_LEN])
+            return slot;
+
+    return -1;
+}
+
+/* Return the slot of file 'name', or -1 if not found.
+ * Arguments: <header> <directory> <file-name>
+ */
+int tyfs_lookup(const struct fs_header_t *header, const char *directory, const char *name)
+{
+    int slot, i;
+    const char *entry;
+
+    if (!name[0])
+        return -1;
+
+    for (slot = 0; slot < header->number_of_file_entries; slot++) {
+        entry = directory + slot * DIR_ENTRY_LEN;
+        for (i = 0; i < FS_NAME_LEN && entry[i] == name[i] && name[i]; i++)
+            ;
+        if (i < FS_NAME_LEN && entry[i] == name[i])
+            return slot;
+    }
+
+    return -1;
+}
+
+#ifndef TYFS_READ_ONLY
+
+/* Return the first free slot, or -1 if the directory is full.
+ * Arguments: <header> <directory>
+ */
+int tyfs_free_slot(const struct fs_header_t *header, const char *directory)
+{
+    int slot;
+
+    for (slot = 0; slot < header->number_of_file_entries; slot++)
+        if (!directory[slot * DIR_ENTRY_LEN])
+            return slot;
+
+    return -1;
+}
+
+#endif /* TYFS_READ_ONLY */
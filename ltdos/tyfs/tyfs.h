@@ -0,0 +1,97 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+/* libtyfs - the TyFS volume layout, shared by tyfsedit and the kernel.
+
+   A volume is made of
+
+     - the header, at the start of the first sector (struct fs_header_t);
+     - the boot sectors, number_of_boot_sectors of them, header included;
+     - the directory, number_of_file_entries entries of DIR_ENTRY_LEN
+       bytes (struct fs_entry_t), free if the name is empty;
+     - the data region, one cluster of max_file_size sectors per entry.
+
+   The directory is not padded to a sector boundary, so clusters need not
+   start at one. Whoever reads the volume passes the header, and the
+   directory as it has it in memory (mapped, or loaded from the disk).
+
+   libtyfs.c uses nothing from the C library, so it builds both on the
+   host (for tyfsedit and kbench) and with the kernel's -m16 (or -m32)
+   --freestanding. The kernel only reads volumes, and its boot sectors are
+   few: it builds libtyfs with TYFS_READ_ONLY defined, which leaves out
+   tyfs_format(), tyfs_check() and tyfs_free_slot(). */
+
+#ifndef TYFS_H
+#define TYFS_H
+
+#define SECTOR_SIZE 512
+#define DIR_ENTRY_LEN 32 /* Directory entry length in bytes.          */
+#define FS_NAME_LEN 24   /* Max file name length, with the NUL.       */
+
+/* In order to allow for the media to be bootable by BIOS, the file system
+   signature starts with a jump instruction that leaps over the header data,
+   and lands at the bootstrap program right next to it. In the present example,
+   the signature is the instruction 'jump 0xe', follwed by the character
+   sequence 'ty' (we thus jump 14 bytes). */
+
+#define FS_SIGNATURE "\xeb\xety" /* File system signature.                   */
+#define FS_SIGLEN 4              /* Signature length.                        */
+
+/* The file header. */
+
+struct fs_header_t {
+    unsigned char signature[FS_SIGLEN];     /* The file system signature.              */
+    unsigned short total_number_of_sectors; /* Number of 512-byte disk blocks.         */
+    unsigned short number_of_boot_sectors;  /* Sectors reserved for boot code.         */
+    unsigned short number_of_file_entries;  /* Maximum number of files in the disk.    */
+    unsigned short max_file_size;           /* Maximum size of a file in blocks.       */
+    unsigned int unused_space;              /* Remaining space less than max_file_size.*/
+} __attribute__((packed));                  /* Disable alignment to preserve offsets.  */
+
+/* A directory entry. The name is NUL-terminated, so older readers see the
+   rest of the entry as padding; there, tyfsedit records the size and the
+   CRC-32 of the file. A recorded size has FS_SIZE_RECORDED set, so that an
+   empty file is told from an entry that predates sizes (all zeros); read
+   it with tyfs_entry_size(), which also leaves out entries of volumes
+   made when names took all 32 bytes. */
+
+#define FS_SIZE_RECORDED 0x80000000u /* In 'size': the size is recorded. */
+
+struct fs_entry_t {
+    char name[FS_NAME_LEN]; /* File name.                              */
+    unsigned int size;      /* File size in bytes, FS_SIZE_RECORDED.   */
+    unsigned int crc;       /* CRC-32 of the file (as zlib's crc32()). */
+} __attribute__((packed));
+
+/* Results of tyfs_check(). */
+
+#define TYFS_OK 0
+#define TYFS_ERR_SIGNATURE 1 /* Not a TyFS volume.                       */
+#define TYFS_ERR_LAYOUT 2    /* Header describes more than the volume.   */
+
+/* Layout. */
+
+int tyfs_format(struct fs_header_t *header);
+int tyfs_check(const struct fs_header_t *header, unsigned int sectors);
+unsigned int tyfs_dir_offset(const struct fs_header_t *header);
+unsigned int tyfs_dir_sectors(const struct fs_header_t *header);
+unsigned int tyfs_slot_offset(const struct fs_header_t *header, int slot);
+unsigned int tyfs_file_size(const struct fs_header_t *header);
+
+/* Directory. */
+
+struct fs_entry_t *tyfs_entry(char *directory, int slot);
+int tyfs_entry_size(const struct fs_header_t *header, const struct fs_entry_t *entry);
+int tyfs_next(const struct fs_header_t *header, const char *directory, int slot);
+int tyfs_lookup(const struct fs_header_t *header, const char *directory, const char *name);
+int tyfs_free_slot(const struct fs_header_t *header, const char *directory);
+
+#endif /* TYFS_H */
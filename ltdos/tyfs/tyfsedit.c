@@ -9,46 +9,61 @@
  *  Tiago Oliva <tiago.oliva.costa@gmail.com>
  */
 
+#define _GNU_SOURCE /* For fallocate() and OFD locks. */
+
 #include <libgen.h>
-#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <glob.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <stdint.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "debug.h"
+#include "tyfs.h" /* Volume layout (libtyfs). */
 
 #define CMD_LINE_LEN 1024 /* Max length of the command line.          */
 #define MAX_ARGS 32       /* Max number of arguments in command line. */
-#define DIR_ENTRY_LEN 32  /* Max file name length in bytes.           */
 
-/* In order to allow for the media to be bootable by BIOS, the file system
-   signature starts with a jump instruction that leaps over the header data,
-   and lands at the bootstrap program right next to it. In the present example,
-   the signature is the instruction 'jump 0xe', follwed by the character
-   sequence 'ty' (we thus jump 14 bytes). */
+/* The open volume is mapped into memory (shared, so that stores go to the
+   image file), and the header, the directory and the data are accessed in
+   place. With no volume open, the header points to an all-zero one. */
+
+struct fs_header_t no_header;
 
-#define FS_SIGNATURE "\xeb\xety" /* File system signature.                   */
-#define FS_SIGLEN 4              /* Signature length.                        */
+char *volume_name = NULL;                  /* Name of the current file.   */
+int volume_fd = -1;                        /* Descriptor of the open file. */
+unsigned char *volume = NULL;              /* The file, mapped in memory.  */
+size_t volume_size = 0;                    /* Size of the mapping.         */
+struct fs_header_t *fs_header = &no_header; /* Header, at the volume start. */
 
-/* The file header. */
+int parse_count(const char *str, unsigned scale, unsigned short *val); /* 16-bit field. */
+int go_on = 1;
 
-struct fs_header_t {
-    unsigned char signature[FS_SIGLEN];     /* The file system signature.              */
-    unsigned short total_number_of_sectors; /* Number of 512-byte disk blocks.         */
-    unsigned short number_of_boot_sectors;  /* Sectors reserved for boot code.         */
-    unsigned short number_of_file_entries;  /* Maximum number of files in the disk.    */
-    unsigned short max_file_size;           /* Maximum size of a file in blocks.       */
-    unsigned int unused_space;              /* Remaining space less than max_file_size.*/
-} __attribute__((packed)) fs_header;        /* Disable alignment to preserve offsets.  */
+/* Commands are read from 'input': the terminal, or a script (see main).
+   In a script, prompts are not shown and the first command that fails
+   stops it. With 'quiet' set, informational messages are not shown;
+   errors always go to stderr. */
 
-char *volume_name = NULL; /* Name of the current file. */
-FILE *volume_fp = NULL;   /* Pointer to the open file. */
+FILE *input;
+int batch = 0;
+int quiet = 0;
+int stdin_commands = 0; /* Commands come from stdin (not just -c). */
 
-int readint(FILE *fp); /* Read user input as an integer (avoid scanf).      */
-int go_on = 1;
+#define info(...)                                                                                  \
+    do {                                                                                           \
+        if (!quiet)                                                                                \
+            printf(__VA_ARGS__);                                                                   \
+    } while (0)
 
 /* User command: command name and pointer to the respective function. */
 
@@ -61,27 +76,191 @@ extern struct cmd_t cmds[];
 int volume_is_open();                  /* Check if volume is open.          */
 int volume_is_fs_header();             /* Check if volume has a TyFS heder. */
 int arg_count(int, int, const char *); /* Check for required number of args. */
+void volume_unmap(void);               /* Sync and unmap the open volume.    */
+int run(char *);                       /* Parse and execute a command line.  */
+int run_script(const char *);          /* Execute the commands in a file.    */
+
+/* Bulk copies (put and get -r) are planned first, as a list of jobs, one
+   per file, each with its cluster in the volume. Then the jobs are run by
+   a pool of threads, and at last the directory is updated. */
+
+struct job_t {
+    char *path;                    /* File in the host.          */
+    char name[FS_NAME_LEN];       /* File in the volume.        */
+    int slot;                      /* Its entry (and cluster).   */
+    unsigned int size, crc;        /* Its size and CRC-32.       */
+    int rs;                        /* Status of the copy.        */
+    int fresh;                     /* New in the volume (sync).  */
+    size_t written;                /* Bytes written (sync).      */
+};
 
-/* There we go. */
+struct job_t *jobs = NULL;
+int job_count = 0;
+
+void add_job(const char *);             /* Add a job for a host file.  */
+void run_jobs(int (*)(struct job_t *)); /* Run all jobs in parallel.   */
+void free_jobs(void);                   /* Release the list of jobs.   */
+int put_job(struct job_t *);            /* Copy a host file in.        */
+int get_tree(int, const char **);       /* Copy all files out (get -r). */
+int verify_job(struct job_t *);         /* Check a file's CRC-32.      */
+int sync_job(struct job_t *);           /* Bring a file up to date.    */
+
+/* Volumes go to and come from POSIX (ustar) tar streams, a header block
+   per file followed by its data, padded to TAR_BLOCK bytes. */
+
+#define TAR_BLOCK 512
+#define TAR_PADDED(size) (((size) + TAR_BLOCK - 1) / TAR_BLOCK * TAR_BLOCK)
+
+struct tar_header_t {
+    char name[100];
+    char mode[8];
+    char uid[8];
+    char gid[8];
+    char size[12];
+    char mtime[12];
+    char chksum[8];
+    char typeflag;
+    char linkname[100];
+    char magic[6]; /* "ustar", with the NUL. */
+    char version[2];
+    char uname[32];
+    char gname[32];
+    char devmajor[8];
+    char devminor[8];
+    char prefix[155];
+    char pad[12];
+};
 
-int main()
+unsigned int tar_checksum(const struct tar_header_t *);
+int tar_skip(size_t);                   /* Read past data in stdin.    */
+void import_done(struct job_t *);       /* Complete an imported file.  */
+
+void crc32_init(void);                  /* Fill in the CRC-32 tables.  */
+unsigned int crc32(const unsigned char *, size_t);
+int get_job(struct job_t *);            /* Copy a volume file out.     */
+struct fs_entry_t *dir_entry(int);    /* The i-th entry of the directory.   */
+
+/* The directory is indexed in memory when a command locks it (see
+   below): a hash table of entry names (chained through 'next') and a
+   stack of free entries, lowest on top. Commands look names up and take
+   or give back entries through the index, and write just the entry they
+   change to the volume. Another tyfsedit may have changed the directory
+   in the meantime. So that this is seen without going through all of the
+   directory, each write to it counts one in a stamp, kept in the unused
+   space after the last cluster (see dir_stamp); the index is made anew if
+   the stamp or the header is not as they were when it was made. On a
+   volume with no room for the stamp, it is made anew at every lock. */
+
+struct {
+    int *bucket;                   /* First entry with each hash.  */
+    int *next;                     /* Next entry with the same.    */
+    char (*name)[FS_NAME_LEN];    /* Name of each entry in use.   */
+    int *free;                     /* Free entries.                */
+    int free_count;
+    unsigned int size;             /* Number of buckets (2^n).     */
+    struct fs_header_t header;     /* The header, as indexed.      */
+    unsigned int stamp;            /* The stamp, as indexed.       */
+    int locked;                    /* How the directory is locked. */
+} dir;
+
+void dir_load(void);                   /* Index the directory.               */
+void dir_unload(void);                 /* Drop the index.                    */
+unsigned int *dir_stamp(void);         /* The directory's change stamp.      */
+int dir_lookup(const char *);          /* Entry with this name, or -1.       */
+int dir_alloc(const char *);           /* Take a free entry for a name.      */
+void dir_release(int);                 /* Give an entry back.                */
+unsigned char *file_data(int);         /* The data of the i-th file.         */
+unsigned int file_length(int);         /* Its size, or its cluster's.        */
+
+/* Several tyfsedit may work on the same volume at once (say, from make -j),
+   so commands lock it, with OFD locks (fcntl): advisory locks that belong
+   to the open volume, and so are shared by the threads that copy files.
+
+     - The header: every command holds a shared lock on it, and 'format'
+       and 'sync', which change the volume as a whole, an exclusive lock
+       on all of the volume instead.
+     - The directory: exclusive while entries are taken, given back or
+       filled in, shared while they are read.
+     - The cluster of a file: exclusive while its data is written, shared
+       while it is read.
+
+   A file goes in three steps. Its entry is reserved, with the directory
+   locked: a free entry is taken, its cluster locked, and the name written
+   (with no size). Then the data is copied, with the directory unlocked,
+   so that files are copied in parallel, in this tyfsedit and in others.
+   At last, the size and CRC-32 are filled in, the directory locked again.
+
+   Locks are taken in that order (header, clusters, directory), and no
+   one waits for a cluster holding the directory, so there are no
+   deadlocks. A command's locks are dropped when it is done. */
+
+int volume_locked = F_UNLCK;           /* F_RDLCK: header; F_WRLCK: all.     */
+int volume_lock(int, off_t, off_t, int); /* Lock or unlock a range.          */
+void volume_lock_all(void);            /* Lock the whole volume, exclusive.  */
+void volume_unlock(void);              /* Drop all the command's locks.      */
+void dir_lock(int);                    /* Lock the directory, and index it.  */
+void dir_unlock(void);                 /* Unlock it.                         */
+int cluster_lock(int, int, int);       /* Lock or unlock a file's cluster.   */
+int dir_reserve(const char *);         /* Reserve an entry for a new file.   */
+int dir_find(const char *, int);       /* Look up a file and lock it.        */
+void dir_lock_files(void);             /* Lock all files for reading.        */
+
+/* There we go.
+
+   Usage: tyfsedit [-q] [-c <command>]... [<script> | -]
+
+   With no arguments, commands are read interactively from stdin. Each
+   '-c' runs one command, and then the commands in <script> (or stdin,
+   if '-'), if given, are run. Lines starting with '#' are comments. The
+   volume is written back once, when the last command is done, and the
+   exit status is that of the first failing command, if any. */
+
+int main(int argc, char **argv)
 {
-    int i, argc;
+    int opt, rs = 0;
     char buffer[CMD_LINE_LEN];
-    char *argv[MAX_ARGS];
 
-    /* Reset header info. */
+    input = stdin;
+    crc32_init();
+
+    while ((opt = getopt(argc, argv, "qc:")) != -1)
+        switch (opt) {
+        case 'q':
+            quiet = 1;
+            break;
+        case 'c':
+            batch = 1;
+            if (go_on && !rs) {
+                strncpy(buffer, optarg, CMD_LINE_LEN - 1);
+                buffer[CMD_LINE_LEN - 1] = '\0';
+                if ((rs = run(buffer)))
+                    fprintf(stderr, "tyfsedit: -c '%s' failed\n", optarg);
+            }
+            break;
+        default:
+            fprintf(stderr, "Usage: tyfsedit [-q] [-c <command>]... [<script> | -]\n");
+            exit(EXIT_FAILURE);
+        }
+
+    if (optind < argc) {
+        batch = 1;
+        if (go_on && !rs)
+            rs = run_script(argv[optind]);
+    }
 
-    memset(&fs_header, 0, sizeof(fs_header));
+    if (batch) {
+        volume_unmap();
+        return rs ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
 
-    printf("TyDOS file manager.\n");
+    info("TyDOS file manager.\n");
+    stdin_commands = 1;
 
     /* Main command interpreter loop. */
 
     while (go_on) {
-        int c;
 
-        /* Read and parse the user input. */
+        /* Read and execute the user input. */
 
         if (!volume_name)
             printf("<none> ");
@@ -89,38 +268,84 @@ int main()
             printf("[%s]> ", volume_name);
 
         fflush(stdout);
-        fgets(buffer, CMD_LINE_LEN - 1, stdin);
-
-        i = 0;
-        while ((argv[i] = strtok(i == 0 ? buffer : NULL, " \t\n")))
-            i++;
-        argc = i;
-
-        /* Execute command. */
-
-        i = 0;
-        if (argv[0])
-            while (cmds[i].func) {
-                if (!strcmp(argv[0], cmds[i].name)) {
-                    cmds[i].func(argc, (const char **)argv);
-                    break;
-                }
-                i++;
-            }
-        if (!cmds[i].func)
-            printf("Command not found\n");
+        if (!fgets(buffer, CMD_LINE_LEN - 1, input))
+            break;
+
+        run(buffer);
     }
 
+    volume_unmap();
+
     return EXIT_SUCCESS;
 }
 
+/* Parse the command line in 'line' and execute it. Return the status of
+   the command (0 on success), or -1 if there is no such command. Blank
+   lines and comments do nothing. */
+
+int run(char *line)
+{
+    int i, argc, rs;
+    char *argv[MAX_ARGS];
+
+    i = 0;
+    while (i < MAX_ARGS - 1 && (argv[i] = strtok(i == 0 ? line : NULL, " \t\n")))
+        i++;
+    argv[i] = NULL;
+    argc = i;
+
+    if (!argv[0] || argv[0][0] == '#')
+        return 0;
+
+    for (i = 0; cmds[i].func; i++)
+        if (!strcmp(argv[0], cmds[i].name)) {
+            rs = cmds[i].func(argc, (const char **)argv);
+            volume_unlock();
+            return rs;
+        }
+
+    fprintf(stderr, "Command not found\n");
+    return -1;
+}
+
+/* Execute the commands in file 'name' ("-" for stdin), one per line, up
+   to 'quit' or the first one that fails. Return the status of the latter. */
+
+int run_script(const char *name)
+{
+    int rs = 0, line = 0;
+    char buffer[CMD_LINE_LEN];
+
+    if (strcmp(name, "-")) {
+        input = fopen(name, "r");
+        sysfault(!input, 1, name);
+    } else
+        stdin_commands = 1;
+
+    while (go_on && fgets(buffer, CMD_LINE_LEN - 1, input)) {
+        line++;
+        if ((rs = run(buffer))) {
+            fprintf(stderr, "tyfsedit: %s:%d: command failed\n", name, line);
+            break;
+        }
+    }
+
+    if (input != stdin)
+        fclose(input);
+    input = stdin;
+
+    return rs;
+}
+
 /*  Open volume.
  *  Arguments: <volume-name>
  */
 
 int f_open(int argc, const char **argv)
 {
-    int rs;
+    int fd;
+    struct stat st;
+    void *map;
 
     /* Precondition check. */
 
@@ -129,16 +354,29 @@ int f_open(int argc, const char **argv)
 
     /* Open the volume. */
 
-    if (volume_fp)
-        fclose(volume_fp);
+    fd = open(argv[1], O_RDWR);
+    sysfault(fd < 0, 1, argv[1]);
 
-    volume_fp = fopen(argv[1], "r+");
-    sysfault(!volume_fp, 1, argv[1]);
+    if (fstat(fd, &st) < 0 || st.st_size < 512) {
+        if (st.st_size < 512)
+            fprintf(stderr, "Volume '%s' is smaller than one sector\n", argv[1]);
+        close(fd);
+        return 1;
+    }
 
-    /* Read volume header. */
+    /* Map the whole file; from now on, the volume is plain memory. */
 
-    rs = fread(&fs_header, sizeof(fs_header), 1, volume_fp);
-    sysfatal(rs < 0);
+    map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+        close(fd);
+    sysfault(map == MAP_FAILED, 1, argv[1]);
+
+    volume_unmap();
+
+    volume_fd = fd;
+    volume = map;
+    volume_size = st.st_size;
+    fs_header = map;
 
     /* Set the prompt string. */
 
@@ -153,19 +391,9 @@ int f_open(int argc, const char **argv)
 
 int f_close(int argc, const char **argv)
 {
-    int rs;
+    /* Write back and close volume. */
 
-    /* Close volume. */
-    if (volume_fp)
-        fclose(volume_fp);
-
-    /* Reset volume name and header info. */
-
-    volume_fp = NULL;
-    free(volume_name);
-    volume_name = NULL;
-
-    memset(&fs_header, 0, sizeof(fs_header));
+    volume_unmap();
 
     return 0;
 }
@@ -180,12 +408,20 @@ int f_help(int argc, const char **argv)
            "open   <image>      open a volume image in the host system\n"
            "close               close a previously opened volume\n"
            "info                show open volume's file system information\n"
-           "format              format the open volume with tyFS\n"
+           "format [<b> <kb>]   format the open volume with tyFS (<b> boot sectors,\n"
+           "       [:zero]      <kb> KiB files); ':zero' also writes zeros to data\n"
            "list                list files in the open volume\n"
-           "put    <file>       copy file from host to the open volume\n"
+           "put    <file>...    copy files (or '*.bin' etc.) from host to the volume\n"
+           "put    -r <dir>     copy all files under host directory <dir> to the volume\n"
            "get    <file>       copy file from the open volume to host\n"
            "get    <file> :dump dump the content of the file on the screen\n"
+           "get    -r <dir>     copy all files in the volume to host directory <dir>\n"
            "delete <file>       remove file from the open volume\n"
+           "verify              check the files in the open volume against their CRC-32\n"
+           "sync   <file>...    make the volume hold exactly these files (or directories),\n"
+           "                    writing only what changed\n"
+           "export              write the volume as a tar stream to stdout (use -q)\n"
+           "import              copy the files of a tar stream from stdin to the volume\n"
            "help                show this help message\n"
            "hlist  [path]       list files in the host system\n"
            "quit                exit the program\n\n");
@@ -199,71 +435,124 @@ int f_help(int argc, const char **argv)
 
 int f_quit(int argc, const char **argv)
 {
-    printf("Bye.\n");
+    info("Bye.\n");
+    volume_unmap();
     go_on = 0;
     return 0;
 }
 
 /*  Format the volume.
- *  Arguments: (none)
+ *  Arguments: [<boot-sectors> <max-file-size-KB>] [:zero]
+ *
+ *  Without the sizes, they are asked interactively. Only the boot sectors
+ *  and the directory are written with zeros; the data region is cleared
+ *  by punching a hole in the file, so it takes no room in the host (and
+ *  no time). With ':zero', the data region is written with zeros too.
  */
 
 int f_format(int argc, const char **argv)
 {
-    int i, rs;
-    float number_of_entries;
+    const char *usage = "Usage: format [<boot-sectors> <max-file-size-KB>] [:zero]\n";
+    struct fs_header_t header;
+    size_t metadata_size, total_size;
+    char boot_line[CMD_LINE_LEN], size_line[CMD_LINE_LEN];
+    const char *boot_sectors, *file_size;
+    unsigned short boot_count, size_count;
+    unsigned int stamp;
+    int zero_fill = 0;
 
     /* Check preconditions. */
 
     if (!volume_is_open())
         return 1;
 
-    /* Get file size (in blocks). */
+    volume_lock_all();
 
-    rs = fseek(volume_fp, 0, SEEK_END);
-    sysfatal(rs < 0);
+    if (argc > 1 && !strcmp(argv[argc - 1], ":zero")) {
+        zero_fill = 1;
+        argc--;
+    }
 
-    fs_header.total_number_of_sectors = ftell(volume_fp) / 512;
-    printf("File has %u blocks of 512 bytes (%d KB)\n", fs_header.total_number_of_sectors,
-           fs_header.total_number_of_sectors / 2);
+    if (argc != 1 && argc != 3) {
+        fprintf(stderr, "%s", usage);
+        return 1;
+    }
+
+    /* Get file size (in blocks). The header has room for 16 bits only. */
+
+    memset(&header, 0, sizeof(header));
 
-    /* Ask how many reserved sectors. */
+    if (volume_size / 512 > 0xffff)
+        info("File exceeds %u blocks; the rest will be left unused\n", 0xffff);
 
-    printf("Number of sectors reserved for boot code : ");
-    fs_header.number_of_boot_sectors = readint(stdin);
+    header.total_number_of_sectors = volume_size / 512 > 0xffff ? 0xffff : volume_size / 512;
+    info("File has %u blocks of 512 bytes (%d KB)\n", header.total_number_of_sectors,
+         header.total_number_of_sectors / 2);
 
-    /* Ask the maximum file size (in KBytes). */
+    if (argc == 3) {
+        boot_sectors = argv[1];
+        file_size = argv[2];
+    } else {
 
-    printf("Maximum file size in KBytes (1024 bytes) : ");
-    fs_header.max_file_size = readint(stdin) * 2;
+        /* Ask how many reserved sectors. */
+
+        printf("Number of sectors reserved for boot code : ");
+        boot_sectors = fgets(boot_line, sizeof(boot_line), input);
+
+        /* Ask the maximum file size (in KBytes). */
+
+        printf("Maximum file size in KBytes (1024 bytes) : ");
+        file_size = fgets(size_line, sizeof(size_line), input);
+    }
+
+    /* Both are 16-bit fields in the header; the file size is kept in
+       sectors, two per KB. */
+
+    if (!boot_sectors || !file_size ||
+        !parse_count(boot_sectors, 1, &boot_count) || !parse_count(file_size, 2, &size_count)) {
+        fprintf(stderr, "%s", usage);
+        return 1;
+    }
+    header.number_of_boot_sectors = boot_count;
+    header.max_file_size = size_count;
 
     /* Compute how may files the volume can support. */
 
-    number_of_entries =
-        (float)(fs_header.total_number_of_sectors - fs_header.number_of_boot_sectors) * 512 /
-        (DIR_ENTRY_LEN + fs_header.max_file_size * 512);
+    if (tyfs_format(&header) < 0) {
+        fprintf(stderr, "Invalid boot sectors or file size for this volume\n");
+        return 1;
+    }
 
-    fs_header.number_of_file_entries = floor(number_of_entries);
+    info("Maximum number of files will be          : %d\n", header.number_of_file_entries);
 
-    printf("Maximum number of files will be          : %d\n", fs_header.number_of_file_entries);
+    if (!header.number_of_file_entries) {
+        fprintf(stderr, "Volume not formatted\n");
+        return 1;
+    }
 
-    fs_header.unused_space =
-        (int)fs_header.total_number_of_sectors * 512 - fs_header.number_of_boot_sectors * 512 -
-        fs_header.number_of_file_entries * (DIR_ENTRY_LEN + fs_header.max_file_size * 512);
+    info("Unused space                             : %d (%.2f KBytes)\n", header.unused_space,
+         (float)header.unused_space / 1024);
 
-    printf("Unused space                             : %d (%.2f KBytes)\n", fs_header.unused_space,
-           (float)fs_header.unused_space / 1024);
+    /* Zero the remaining of the file: the data region first (a hole reads
+       as zeros), then the boot sectors and the directory. */
 
-    strncpy(fs_header.signature, FS_SIGNATURE, FS_SIGLEN);
+    metadata_size = tyfs_slot_offset(&header, 0);
+    total_size = (size_t)header.total_number_of_sectors * 512;
+    stamp = dir_stamp() ? *dir_stamp() : 0;
 
-    fseek(volume_fp, 0, SEEK_SET);
+    if (zero_fill || fallocate(volume_fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                               metadata_size, total_size - metadata_size) < 0)
+        memset(volume + metadata_size, 0, total_size - metadata_size);
 
-    fwrite(&fs_header, 1, sizeof(fs_header), volume_fp);
+    memset(volume, 0, metadata_size);
+    memcpy(fs_header, &header, sizeof(header));
+    dir_unload();
 
-    /* Zero the remaining of the file. */
+    /* Count the new directory in the stamp, so that other tyfsedit with
+       the volume open see it (see dir_lock). */
 
-    for (i = sizeof(fs_header); i < fs_header.total_number_of_sectors * 512; i++)
-        fwrite("\0", 1, 1, volume_fp);
+    if (dir_stamp())
+        *dir_stamp() = stamp + 1;
 
     return 0;
 }
@@ -282,13 +571,13 @@ int f_info(int argc, const char **argv)
 
     printf("Volume info reported by FS_HEADER header:\n");
     printf("phisical volume size           : %d blocks (%d bytes) \n",
-           fs_header.total_number_of_sectors, fs_header.total_number_of_sectors * 512);
-    printf("number of reserved sectors     : %d blocks\n", fs_header.number_of_boot_sectors);
-    printf("maximum number of file entries : %d files\n", fs_header.number_of_file_entries);
-    printf("maximum supported file size    : %d bytes (%.2f KiB)\n", fs_header.max_file_size * 512,
-           (float)fs_header.max_file_size / 2);
-    printf("unused space                   : %d bytes (%.2f KiB)\n", fs_header.unused_space,
-           (float)fs_header.unused_space / 1024);
+           fs_header->total_number_of_sectors, fs_header->total_number_of_sectors * 512);
+    printf("number of reserved sectors     : %d blocks\n", fs_header->number_of_boot_sectors);
+    printf("maximum number of file entries : %d files\n", fs_header->number_of_file_entries);
+    printf("maximum supported file size    : %u bytes (%.2f KiB)\n", tyfs_file_size(fs_header),
+           (float)fs_header->max_file_size / 2);
+    printf("unused space                   : %d bytes (%.2f KiB)\n", fs_header->unused_space,
+           (float)fs_header->unused_space / 1024);
 
     return 0;
 }
@@ -300,122 +589,202 @@ int f_info(int argc, const char **argv)
 int f_list(int argc, const char **argv)
 {
     int i;
-    char name[DIR_ENTRY_LEN];
+    char *directory;
 
     /* Check preconditions. */
 
     if (!volume_is_open() || !volume_is_fs_header())
         return 1;
 
-    /* Position at the begining of the directory region. */
-
-    fseek(volume_fp, fs_header.number_of_boot_sectors * 512, SEEK_SET);
+    /* Go through the files in the directory region. */
 
-    /* Read all entries. */
-
-    for (i = 0; i < fs_header.number_of_file_entries; i++) {
-        fread(name, DIR_ENTRY_LEN, 1, volume_fp);
-        if (name[0]) {
-            fwrite(name, DIR_ENTRY_LEN, 1, stdout);
-            printf("\n");
-        }
-    }
+    dir_lock(F_RDLCK);
+    directory = (char *)dir_entry(0);
+    for (i = tyfs_next(fs_header, directory, -1); i >= 0; i = tyfs_next(fs_header, directory, i))
+        printf("%.*s\n", FS_NAME_LEN, dir_entry(i)->name);
+    dir_unlock();
 
     return 0;
 }
 
-/* Copy a file from the host file system to the volume.
- * Arguments: <file-name>
+/* Copy files from the host file system to the volume.
+ * Arguments: <file-name>... | -r <directory>
  *
  * Notes: file name is an ASCII string with not blanks.
  *        Quotes are not parsed as in usual shell grammar.
+ *        File names may be glob patterns, like '*.bin', and '-r' copies
+ *        all the files under a directory. Each file is stored under its
+ *        base name. If any of them can't go in, none is copied.
  */
 
+/* Add a regular file found under a directory given to 'put -r' or 'sync'. */
+
+int add_tree_file(const char *path, const struct stat *st, int type, struct FTW *ftw)
+{
+    if (type == FTW_F && S_ISREG(st->st_mode))
+        add_job(path);
+    return 0;
+}
+
 int f_put(int argc, const char **argv)
 {
-    int i, j, c, rs;
-    char buffer[DIR_ENTRY_LEN];
-    char out_file_name;
-    FILE *fpin;
+    int i, k, rs;
+    glob_t paths;
+    struct stat st;
 
     /* Check preconditions. */
 
     if (!volume_is_open() || !volume_is_fs_header())
         return 1;
 
-    if (!arg_count(argc, 2, "Usage: put <file-name>"))
+    if (!arg_count(argc, 2, "Usage: put <file-name>... | put -r <directory>"))
         return 1;
 
-    /* Position at the begining of the directory reagion. */
+    /* Make the list of host files. */
 
-    fseek(volume_fp, fs_header.number_of_boot_sectors * 512, SEEK_SET);
+    if (!strcmp(argv[1], "-r")) {
+        if (!arg_count(argc, 3, "Usage: put -r <directory>"))
+            return 1;
+        rs = nftw(argv[2], add_tree_file, 16, FTW_PHYS);
+        if (rs < 0)
+            free_jobs();
+        sysfault(rs < 0, 1, argv[2]);
+    } else {
+        for (i = 1; i < argc; i++)
+            glob(argv[i], (i > 1 ? GLOB_APPEND : 0) | GLOB_NOCHECK, NULL, &paths);
+        for (i = 0; i < (int)paths.gl_pathc; i++)
+            add_job(paths.gl_pathv[i]);
+        globfree(&paths);
+    }
 
-    /* Check for either free entry or a matching file name. */
+    /* Plan: give each file a name, and check it can go in. */
 
-    i = -1;
-    do {
-        fread(buffer, DIR_ENTRY_LEN, 1, volume_fp);
+    rs = 0;
+    for (k = 0; k < job_count; k++) {
+        if (strlen(basename(jobs[k].path)) >= FS_NAME_LEN) {
+            fprintf(stderr, "File name too long (%s)\n", jobs[k].path);
+            rs = 1;
+            break;
+        }
+        strncpy(jobs[k].name, basename(jobs[k].path), FS_NAME_LEN - 1);
 
-        if (!strncmp(buffer, argv[1], DIR_ENTRY_LEN)) {
-            printf("File '%s' already exists in the volume\n", argv[1]);
-            return 1;
+        if (stat(jobs[k].path, &st) < 0) {
+            fprintf(stderr, "%s (%s)\n", strerror(errno), jobs[k].path);
+            rs = 1;
+            break;
         }
+        if (!S_ISREG(st.st_mode)) {
+            fprintf(stderr, "Not a regular file (%s)\n", jobs[k].path);
+            rs = 1;
+            break;
+        }
+        if (st.st_size > tyfs_file_size(fs_header)) {
+            fprintf(stderr, "File too large (%s)\n", jobs[k].path);
+            rs = 1;
+            break;
+        }
+    }
 
-        i++;
-    } while ((buffer[0] != '\0') && (i < fs_header.number_of_file_entries));
+    if (rs) {
+        free_jobs();
+        return rs;
+    }
 
-    if (i == fs_header.number_of_file_entries) {
-        printf("Volume is full\n");
-        return 1;
+    /* Reserve an entry for each file, checking it's not there yet (nor
+       earlier in the list). If any can't go in, the entries are given
+       back, in reverse order, so that the stack of free ones is left as
+       it was. */
+
+    dir_lock(F_WRLCK);
+
+    for (k = 0; k < job_count; k++) {
+        if (dir_lookup(jobs[k].name) >= 0) {
+            fprintf(stderr, "File '%s' already exists in the volume\n", jobs[k].path);
+            rs = 1;
+            break;
+        }
+
+        jobs[k].slot = dir_reserve(jobs[k].name);
+        if (jobs[k].slot < 0) {
+            fprintf(stderr, "Volume is full\n");
+            rs = 1;
+            break;
+        }
     }
 
-    /* Position at the i-th entry at the directory region. */
+    if (rs)
+        while (k-- > 0) {
+            memset(dir_entry(jobs[k].slot), 0, DIR_ENTRY_LEN);
+            dir_release(jobs[k].slot);
+        }
+
+    dir_unlock();
 
-    fseek(volume_fp,
-          fs_header.number_of_boot_sectors * 512 +
-              fs_header.number_of_file_entries * DIR_ENTRY_LEN + fs_header.max_file_size * 512 * i,
-          SEEK_SET);
+    /* Copy the files in, and then complete the entries of those that made
+       it, and give back those of the others. */
 
-    /* Open the local file (in the host). */
+    if (!rs) {
+        run_jobs(put_job);
 
-    fpin = fopen(argv[1], "r");
-    sysfault(!fpin, 1, argv[1]);
+        dir_lock(F_WRLCK);
 
-    /* Copy the file in to the volume. */
+        for (k = job_count - 1; k >= 0; k--)
+            if (jobs[k].rs) {
+                memset(dir_entry(jobs[k].slot), 0, DIR_ENTRY_LEN);
+                dir_release(jobs[k].slot);
+                rs = 1;
+            }
 
-    j = 0;
-    while (((c = fgetc(fpin)) != EOF) && (j < fs_header.max_file_size * 512)) {
-        fwrite(&c, 1, 1, volume_fp);
-        j++;
+        for (k = 0; k < job_count; k++)
+            if (!jobs[k].rs) {
+                dir_entry(jobs[k].slot)->size = jobs[k].size | FS_SIZE_RECORDED;
+                dir_entry(jobs[k].slot)->crc = jobs[k].crc;
+                info("File '%s' copied at entry %d\n", jobs[k].path, jobs[k].slot);
+            }
+
+        dir_unlock();
     }
-    if (ferror(fpin))
-        sysfatal(1);
 
-    fclose(fpin);
+    free_jobs();
 
-    /* If everything works up to this point, create file entry.
+    return rs;
+}
 
-       Position at the ith-entry in the file directory region
-       and write the entry. */
+/* Copy a file in to its cluster of the data region, straight into the
+   mapped volume, and take its CRC-32 there. */
 
-    fseek(volume_fp, fs_header.number_of_boot_sectors * 512 + DIR_ENTRY_LEN * i, SEEK_SET);
+int put_job(struct job_t *job)
+{
+    int fd;
+    ssize_t n = 0;
+    size_t size = 0, max = tyfs_file_size(fs_header);
+    unsigned char *data = file_data(job->slot);
 
-    strncpy(buffer, basename((char *)argv[1]), DIR_ENTRY_LEN);
-    fwrite(buffer, DIR_ENTRY_LEN, 1, volume_fp);
+    fd = open(job->path, O_RDONLY);
+    sysfault(fd < 0, 1, job->path);
 
-    printf("File '%s' copied at entry %d\n", argv[1], i);
+    while (size < max && (n = pread(fd, data + size, max - size, size)) > 0)
+        size += n;
+
+    close(fd);
+    sysfault(n < 0, 1, job->path);
+
+    job->size = size;
+    job->crc = crc32(data, size);
 
     return 0;
 }
 
 /* Copy a file from the volume into the host file system.
- * Arguments: <file-name> [optional].
+ * Arguments: <file-name> [optional] | -r <directory>
  *
  * If and optional argument is not provided, a file with the same is
  * created (or overwritten) in the host file system. If the option is
  * ':dump' the file content is dumped on the screen; if the optional
  * argument is something else, it indicates the name of the destination
- * file in the host system.
+ * file in the host system. With '-r', all files are copied into the
+ * given directory (which is created if needed). Files come out with the
+ * size recorded for them, or as their whole cluster (see file_length).
  *
  * Notes: file name is an ASCII string with not blanks.
  *        Quotes are not parsed as in usual shell grammar.
@@ -423,9 +792,9 @@ int f_put(int argc, const char **argv)
 
 int f_get(int argc, const char **argv)
 {
-    int i, c;
+    int i;
+    unsigned int size;
     FILE *fpout;
-    char buffer[DIR_ENTRY_LEN];
     char *out_file_name;
 
     /* Check preconditions. */
@@ -433,33 +802,23 @@ int f_get(int argc, const char **argv)
     if (!volume_is_open() || !volume_is_fs_header())
         return 1;
 
-    if (!arg_count(argc, 2, "Usage: get [-d] <file-name>"))
+    if (!arg_count(argc, 2, "Usage: get <file-name> [<host-file> | :dump] | get -r <directory>"))
         return 1;
 
-    /* Position at the begining of the file directory region. */
+    if (!strcmp(argv[1], "-r"))
+        return get_tree(argc, argv);
 
-    fseek(volume_fp, fs_header.number_of_boot_sectors * 512, SEEK_SET);
+    /* Search for the file name, and lock the file for reading. */
 
-    /* Search for the file name. */
+    i = dir_find(argv[1], F_RDLCK);
+    size = i < 0 ? 0 : file_length(i);
+    dir_unlock();
 
-    i = -1;
-    do {
-        fread(buffer, DIR_ENTRY_LEN, 1, volume_fp);
-        i++;
-    } while (strncmp(buffer, argv[1], DIR_ENTRY_LEN) && (i < fs_header.number_of_file_entries));
-
-    if (i == fs_header.number_of_file_entries) {
-        printf("File '%s' not found in the volume\n", argv[1]);
+    if (i < 0) {
+        fprintf(stderr, "File '%s' not found in the volume\n", argv[1]);
         return 1;
     }
 
-    /* Position at the ith-entry in the data region. */
-
-    fseek(volume_fp,
-          fs_header.number_of_boot_sectors * 512 +
-              fs_header.number_of_file_entries * DIR_ENTRY_LEN + fs_header.max_file_size * 512 * i,
-          SEEK_SET);
-
     /* Determine the destination stream. */
 
     if (argc < 3)
@@ -477,13 +836,9 @@ int f_get(int argc, const char **argv)
     } else
         fpout = stdout;
 
-    /* Copy the content in the volume into the local file. */
+    /* Copy the file (see file_length) into the local file. */
 
-    i = 0;
-    while (((c = fgetc(volume_fp)) != EOF) && (i < fs_header.max_file_size * 512)) {
-        fputc(c, fpout);
-        i++;
-    }
+    fwrite(file_data(i), 1, size, fpout);
     if (ferror(fpout))
         sysfatal(1);
 
@@ -493,48 +848,657 @@ int f_get(int argc, const char **argv)
     return 0;
 }
 
-/* Delete a file in the volume.
- * Arguments: <file-name>
+/* Copy all files in the volume into a host directory (get -r). */
+
+int get_tree(int argc, const char **argv)
+{
+    int i, k, rs;
+
+    if (!arg_count(argc, 3, "Usage: get -r <directory>"))
+        return 1;
+
+    rs = mkdir(argv[2], 0777);
+    sysfault(rs < 0 && errno != EEXIST, 1, argv[2]);
+
+    dir_lock_files();
+
+    jobs = calloc(fs_header->number_of_file_entries, sizeof(*jobs));
+    sysfatal(!jobs);
+
+    for (i = 0; i < fs_header->number_of_file_entries; i++) {
+        if (!dir_entry(i)->name[0])
+            continue;
+        k = job_count++;
+        memcpy(jobs[k].name, dir_entry(i)->name, FS_NAME_LEN - 1);
+        jobs[k].slot = i;
+        jobs[k].size = file_length(i);
+        jobs[k].path = malloc(strlen(argv[2]) + FS_NAME_LEN + 1);
+        sysfatal(!jobs[k].path);
+        sprintf(jobs[k].path, "%s/%s", argv[2], jobs[k].name);
+    }
+
+    dir_unlock();
+    run_jobs(get_job);
+
+    rs = 0;
+    for (k = 0; k < job_count; k++)
+        rs |= jobs[k].rs;
+
+    free_jobs();
+
+    return rs;
+}
+
+/* Copy the cluster of a file in the volume into a host file. */
+
+int get_job(struct job_t *job)
+{
+    int fd;
+    ssize_t n = 0;
+    size_t size = 0, max = job->size;
+    unsigned char *data = file_data(job->slot);
+
+    fd = open(job->path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    sysfault(fd < 0, 1, job->path);
+
+    while (size < max && (n = pwrite(fd, data + size, max - size, size)) > 0)
+        size += n;
+
+    close(fd);
+    sysfault(n < 0, 1, job->path);
+
+    return 0;
+}
+
+/* Check the files in the volume against their CRC-32.
+ * Arguments: (none)
+ *
+ * Files are checked in parallel (see run_jobs). Those with no size
+ * recorded are skipped, and those that don't match are reported. Return
+ * 1 if any file does not match.
  */
 
-int f_delete(int argc, const char **argv)
+int f_verify(int argc, const char **argv)
 {
-    int i;
-    char buffer[DIR_ENTRY_LEN];
+    int i, k, bad = 0;
+    double bytes = 0, seconds;
+    struct timespec start, end;
 
     /* Check preconditions. */
 
     if (!volume_is_open() || !volume_is_fs_header())
         return 1;
 
-    if (!arg_count(argc, 2, "Usage: get <file-name>"))
+    dir_lock_files();
+
+    jobs = calloc(fs_header->number_of_file_entries, sizeof(*jobs));
+    sysfatal(!jobs);
+
+    for (i = 0; i < fs_header->number_of_file_entries; i++) {
+        if (!dir_entry(i)->name[0] || tyfs_entry_size(fs_header, dir_entry(i)) < 0)
+            continue;
+        k = job_count++;
+        memcpy(jobs[k].name, dir_entry(i)->name, FS_NAME_LEN - 1);
+        jobs[k].slot = i;
+        jobs[k].size = file_length(i);
+        jobs[k].crc = dir_entry(i)->crc;
+        bytes += jobs[k].size;
+    }
+
+    dir_unlock();
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    run_jobs(verify_job);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    for (k = 0; k < job_count; k++)
+        if (jobs[k].rs) {
+            fprintf(stderr, "File '%s' does not match its checksum\n", jobs[k].name);
+            bad++;
+        }
+
+    printf("%d files checked, %d bad, %.0f bytes in %.3f ms (%.1f MB/s)\n", job_count, bad, bytes,
+           seconds * 1e3, seconds > 0 ? bytes / seconds / 1e6 : 0);
+
+    free_jobs();
+
+    return bad != 0;
+}
+
+int verify_job(struct job_t *job)
+{
+    if (job->size > tyfs_file_size(fs_header))
         return 1;
 
-    /* Position at the begining of the directory region. */
+    return crc32(file_data(job->slot), job->size) != job->crc;
+}
 
-    fseek(volume_fp, fs_header.number_of_boot_sectors * 512, SEEK_SET);
+/* Make the volume hold exactly the given host files, writing only what
+ * differs.
+ * Arguments: <file-name>...
+ *
+ * Notes: file names may be glob patterns, and directories stand for all
+ *        the files under them (as in 'put'). Files already in the volume
+ *        with the same size and CRC-32 are left alone; for the others,
+ *        only the sectors that differ are written (with the volume
+ *        mapped, no others reach the image file). Files in the volume
+ *        that are not given are deleted.
+ */
 
-    /* Search for the file name. */
+int cmp_job_names(const void *a, const void *b)
+{
+    return strcmp((*(struct job_t **)a)->name, (*(struct job_t **)b)->name);
+}
 
-    i = -1;
-    do {
-        fread(buffer, DIR_ENTRY_LEN, 1, volume_fp);
-        i++;
-    } while (strncmp(buffer, argv[1], DIR_ENTRY_LEN) && (i < fs_header.number_of_file_entries));
+int f_sync(int argc, const char **argv)
+{
+    int i, k, rs = 0, added = 0, updated = 0, deleted = 0;
+    size_t written = 0;
+    glob_t paths;
+    struct stat st;
+    struct job_t **sorted;
+    char *keep;
+
+    /* Check preconditions. */
+
+    if (!arg_count(argc, 2, "Usage: sync <file-name-or-directory>..."))
+        return 1;
 
-    if (i == fs_header.number_of_file_entries) {
-        printf("File '%s' not found in the volume\n", argv[1]);
+    if (!volume_is_open())
+        return 1;
+
+    volume_lock_all();
+
+    if (!volume_is_fs_header())
         return 1;
+
+    /* Make the list of host files, as 'put' does. */
+
+    for (i = 1; i < argc; i++) {
+        if (!stat(argv[i], &st) && S_ISDIR(st.st_mode)) {
+            rs = nftw(argv[i], add_tree_file, 16, FTW_PHYS);
+            if (rs < 0)
+                free_jobs();
+            sysfault(rs < 0, 1, argv[i]);
+            continue;
+        }
+        glob(argv[i], GLOB_NOCHECK, NULL, &paths);
+        for (k = 0; k < (int)paths.gl_pathc; k++)
+            add_job(paths.gl_pathv[k]);
+        globfree(&paths);
     }
 
-    /* Position at the respective entry in the directory region.*/
+    /* Plan: check every file, and find which are in the volume already. */
+
+    for (k = 0; k < job_count && !rs; k++) {
+        if (strlen(basename(jobs[k].path)) >= FS_NAME_LEN) {
+            fprintf(stderr, "File name too long (%s)\n", jobs[k].path);
+            rs = 1;
+        } else if (stat(jobs[k].path, &st) < 0) {
+            fprintf(stderr, "%s (%s)\n", strerror(errno), jobs[k].path);
+            rs = 1;
+        } else if (!S_ISREG(st.st_mode)) {
+            fprintf(stderr, "Not a regular file (%s)\n", jobs[k].path);
+            rs = 1;
+        } else if (st.st_size > tyfs_file_size(fs_header)) {
+            fprintf(stderr, "File too large (%s)\n", jobs[k].path);
+            rs = 1;
+        }
+    }
+
+    dir_lock(F_WRLCK);
+
+    for (k = 0; k < job_count; k++) {
+        strncpy(jobs[k].name, basename(jobs[k].path), FS_NAME_LEN - 1);
+        jobs[k].slot = dir_lookup(jobs[k].name);
+    }
+
+    sorted = malloc(job_count * sizeof(*sorted) + 1);
+    keep = calloc(fs_header->number_of_file_entries + 1, 1);
+    sysfatal(!sorted || !keep);
+
+    for (k = 0; k < job_count; k++)
+        sorted[k] = &jobs[k];
+    qsort(sorted, job_count, sizeof(*sorted), cmp_job_names);
+    for (k = 1; k < job_count && !rs; k++)
+        if (!strcmp(sorted[k - 1]->name, sorted[k]->name)) {
+            fprintf(stderr, "File '%s' given twice\n", sorted[k]->name);
+            rs = 1;
+        }
+
+    for (k = 0; k < job_count; k++)
+        if (jobs[k].slot >= 0)
+            keep[jobs[k].slot] = 1;
+        else
+            added++;
+
+    for (i = 0; i < fs_header->number_of_file_entries; i++)
+        if (dir_entry(i)->name[0] && !keep[i])
+            deleted++;
+
+    if (!rs && added > dir.free_count + deleted) {
+        fprintf(stderr, "Volume is full\n");
+        rs = 1;
+    }
+
+    /* Delete what's gone, then give the new files an entry, and bring
+       all files up to date. */
+
+    if (!rs) {
+        for (i = fs_header->number_of_file_entries - 1; i >= 0; i--)
+            if (dir_entry(i)->name[0] && !keep[i]) {
+                memset(dir_entry(i), 0, DIR_ENTRY_LEN);
+                dir_release(i);
+                written += DIR_ENTRY_LEN;
+            }
+
+        for (k = 0; k < job_count; k++)
+            if (jobs[k].slot < 0) {
+                jobs[k].slot = dir_alloc(jobs[k].name);
+                jobs[k].fresh = 1;
+            }
+
+        run_jobs(sync_job);
+
+        for (k = 0; k < job_count; k++) {
+            struct fs_entry_t *entry = dir_entry(jobs[k].slot);
+
+            if (jobs[k].rs) {
+                rs = 1;
+                if (jobs[k].fresh)
+                    dir_release(jobs[k].slot);
+                continue;
+            }
+            written += jobs[k].written;
+            if (!jobs[k].fresh && tyfs_entry_size(fs_header, entry) == (int)jobs[k].size &&
+                entry->crc == jobs[k].crc)
+                continue;
+            if (!jobs[k].fresh)
+                updated++;
+            memcpy(entry->name, jobs[k].name, FS_NAME_LEN);
+            entry->size = jobs[k].size | FS_SIZE_RECORDED;
+            entry->crc = jobs[k].crc;
+            written += DIR_ENTRY_LEN;
+        }
+
+        info("%d added, %d updated, %d deleted, %d unchanged, %zu bytes written\n", added,
+             updated, deleted, job_count - added - updated, written);
+    }
+
+    dir_unlock();
+
+    free(sorted);
+    free(keep);
+    free_jobs();
+
+    return rs;
+}
+
+/* Bring the cluster of a file up to date with the host file: if its size
+   or CRC-32 differ from those in the entry, compare it sector by sector,
+   up to the end of the cluster (past the file, sectors must be zero), and
+   write those that differ. */
+
+int sync_job(struct job_t *job)
+{
+    static const unsigned char zeros[512];
+    int fd;
+    ssize_t n = 0;
+    size_t size = 0, max = tyfs_file_size(fs_header), sector, length;
+    unsigned char *data = file_data(job->slot), *buffer;
+    struct fs_entry_t *entry = dir_entry(job->slot);
+
+    buffer = malloc(max);
+    sysfatal(!buffer);
+
+    fd = open(job->path, O_RDONLY);
+    if (fd < 0)
+        free(buffer);
+    sysfault(fd < 0, 1, job->path);
+
+    while (size < max && (n = pread(fd, buffer + size, max - size, size)) > 0)
+        size += n;
+
+    close(fd);
+    if (n < 0)
+        free(buffer);
+    sysfault(n < 0, 1, job->path);
+
+    job->size = size;
+    job->crc = crc32(buffer, size);
+
+    if (job->fresh || entry->size != job->size || entry->crc != job->crc)
+        for (sector = 0; sector < max; sector += 512) {
+            length = sector < size ? (size - sector < 512 ? size - sector : 512) : 0;
+            if (memcmp(data + sector, buffer + sector, length) ||
+                memcmp(data + sector + length, zeros, 512 - length)) {
+                memcpy(data + sector, buffer + sector, length);
+                memset(data + sector + length, 0, 512 - length);
+                job->written += 512;
+            }
+        }
+
+    free(buffer);
+
+    return 0;
+}
+
+/* Write the volume as a tar stream to stdout.
+ * Arguments: (none)
+ *
+ * Files go straight from their clusters, in directory order, as many
+ * bytes as 'get' copies (see file_length). TyFS keeps no owner,
+ * mode or time, so all files are 0644, owned by root, from the epoch: the
+ * stream depends on the files only, and two volumes can be diffed by it.
+ * Messages would go to stdout too: use -q.
+ */
+
+int f_export(int argc, const char **argv)
+{
+    int k;
+    unsigned int size;
+    char zeros[TAR_BLOCK] = {0};
+    struct tar_header_t header;
+
+    /* Check preconditions. */
+
+    if (!volume_is_open() || !volume_is_fs_header())
+        return 1;
+
+    if (isatty(STDOUT_FILENO)) {
+        fprintf(stderr, "Won't write a tar stream to a terminal\n");
+        return 1;
+    }
+
+    /* List the files, and hold them while they are written. */
+
+    dir_lock_files();
+
+    jobs = calloc(fs_header->number_of_file_entries, sizeof(*jobs));
+    sysfatal(!jobs);
+
+    for (k = tyfs_next(fs_header, (char *)dir_entry(0), -1); k >= 0;
+         k = tyfs_next(fs_header, (char *)dir_entry(0), k)) {
+        memcpy(jobs[job_count].name, dir_entry(k)->name, FS_NAME_LEN - 1);
+        jobs[job_count].slot = k;
+        jobs[job_count].size = file_length(k);
+        job_count++;
+    }
+
+    dir_unlock();
+
+    for (k = 0; k < job_count; k++) {
+        size = jobs[k].size;
+
+        memset(&header, 0, sizeof(header));
+        strcpy(header.name, jobs[k].name);
+        strcpy(header.mode, "0000644");
+        strcpy(header.uid, "0000000");
+        strcpy(header.gid, "0000000");
+        sprintf(header.size, "%011o", size);
+        strcpy(header.mtime, "00000000000");
+        header.typeflag = '0';
+        memcpy(header.magic, "ustar", 6);
+        memcpy(header.version, "00", 2);
+        sprintf(header.chksum, "%06o", tar_checksum(&header));
+        header.chksum[7] = ' ';
+
+        fwrite(&header, 1, sizeof(header), stdout);
+        fwrite(file_data(jobs[k].slot), 1, size, stdout);
+        fwrite(zeros, 1, TAR_PADDED(size) - size, stdout);
+    }
+
+    /* The end of the archive: two zero blocks. */
+
+    fwrite(zeros, 1, TAR_BLOCK, stdout);
+    fwrite(zeros, 1, TAR_BLOCK, stdout);
+    fflush(stdout);
+
+    free_jobs();
+
+    sysfault(ferror(stdout), 1, "stdout");
+
+    return 0;
+}
+
+/* Sum of the header bytes, with the checksum field taken as blanks. */
+
+unsigned int tar_checksum(const struct tar_header_t *header)
+{
+    unsigned int i, sum = 0;
+    const unsigned char *bytes = (const unsigned char *)header;
 
-    fseek(volume_fp, -DIR_ENTRY_LEN, SEEK_CUR);
+    for (i = 0; i < sizeof(*header); i++)
+        sum += bytes[i];
+    for (i = 0; i < sizeof(header->chksum); i++)
+        sum += ' ' - (unsigned char)header->chksum[i];
+
+    return sum;
+}
+
+/* Copy the files in a tar stream from stdin to the volume.
+ * Arguments: (none)
+ *
+ * Each file is read straight into its cluster: its entry is reserved
+ * (see dir_reserve) when its header comes, and completed along with the
+ * reservation of the next one, so the directory is locked once per file.
+ * Files go by the last component of their path, as with 'put -r';
+ * directories are skipped, and so are (with a warning) links and other
+ * special files. The stream can't come from where the commands do: use
+ * -c, as in 'tar c ... | tyfsedit -c "open disk.img" -c import'.
+ */
+
+int f_import(int argc, const char **argv)
+{
+    int i, rs = 0, count = 0;
+    size_t n, size;
+    double bytes = 0;
+    char path[155 + 1 + 100 + 1]; /* Prefix, '/', name. */
+    char *name;
+    struct tar_header_t header;
+    struct job_t done = {.slot = -1}; /* The file read last. */
+
+    /* Check preconditions. */
+
+    if (!volume_is_open() || !volume_is_fs_header())
+        return 1;
+
+    if (stdin_commands || isatty(STDIN_FILENO)) {
+        fprintf(stderr, "Commands are read from stdin; give them with -c\n");
+        return 1;
+    }
+
+    while (1) {
+
+        /* A header block; a zero one (or the end of stdin) ends the stream. */
+
+        n = fread(&header, 1, sizeof(header), stdin);
+        if (n == 0 || (n == sizeof(header) && !header.name[0] &&
+                       tar_checksum(&header) == 8 * ' '))
+            break;
+
+        if (n < sizeof(header)) {
+            fprintf(stderr, "Unexpected end of tar stream\n");
+            rs = 1;
+            break;
+        }
+
+        if (strtoul(header.chksum, NULL, 8) != tar_checksum(&header)) {
+            fprintf(stderr, "Not a tar stream (bad header checksum)\n");
+            rs = 1;
+            break;
+        }
+
+        if (header.size[0] & 0x80) { /* Base-256: too large anyway. */
+            fprintf(stderr, "File too large (%.100s)\n", header.name);
+            rs = 1;
+            break;
+        }
+        size = strtoul(header.size, NULL, 8);
+
+        /* Full name, and the file's name in the volume. */
+
+        if (!memcmp(header.magic, "ustar", 5) && header.prefix[0])
+            sprintf(path, "%.155s/%.100s", header.prefix, header.name);
+        else
+            sprintf(path, "%.100s", header.name);
+
+        for (i = strlen(path); i > 0 && path[i - 1] == '/'; i--)
+            path[i - 1] = '\0';
+        name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+
+        switch (header.typeflag) {
+        case '0':
+        case '\0':
+        case '7':
+            break;
+        case '5':  /* Directory.                      */
+        case 'x':  /* Extended (pax) header, skipped. */
+        case 'g':
+            if ((rs = tar_skip(TAR_PADDED(size))))
+                break;
+            continue;
+        case 'L': /* GNU long name: too long for TyFS. */
+            fprintf(stderr, "File name too long (%.100s...)\n", path);
+            rs = 1;
+            break;
+        default:
+            fprintf(stderr, "Not a regular file, skipped (%s)\n", path);
+            if ((rs = tar_skip(TAR_PADDED(size))))
+                break;
+            continue;
+        }
+        if (rs)
+            break;
+
+        if (strlen(name) >= FS_NAME_LEN || !name[0]) {
+            fprintf(stderr, "File name too long (%s)\n", path);
+            rs = 1;
+            break;
+        }
+        if (size > tyfs_file_size(fs_header)) {
+            fprintf(stderr, "File too large (%s)\n", path);
+            rs = 1;
+            break;
+        }
+
+        /* Reserve the entry, and read the data into the cluster. */
+
+        dir_lock(F_WRLCK);
+        import_done(&done);
+        if (dir_lookup(name) >= 0) {
+            fprintf(stderr, "File '%s' already exists in the volume\n", path);
+            rs = 1;
+        } else if ((i = dir_reserve(name)) < 0) {
+            fprintf(stderr, "Volume is full\n");
+            rs = 1;
+        }
+        dir_unlock();
+        if (rs)
+            break;
+
+        done.slot = i;
+        done.size = fread(file_data(i), 1, size, stdin);
+        done.crc = crc32(file_data(i), done.size);
+        done.rs = done.size < size || tar_skip(TAR_PADDED(size) - size);
+
+        if ((rs = done.rs)) {
+            fprintf(stderr, "Unexpected end of tar stream (%s)\n", path);
+            break;
+        }
+
+        count++;
+        bytes += size;
+    }
+
+    dir_lock(F_WRLCK);
+    import_done(&done);
+    dir_unlock();
+
+    /* Let the writer finish (tar pads the stream to its record size). */
+
+    if (!rs)
+        while (fread(&header, 1, sizeof(header), stdin) > 0)
+            ;
+
+    sysfault(ferror(stdin), 1, "stdin");
+
+    info("%d files imported, %.0f bytes\n", count, bytes);
+
+    return rs;
+}
+
+/* Fill in the entry of the file imported last (or give it back, if its
+   data did not all come), with the directory locked for writing, and let
+   others read it. */
+
+void import_done(struct job_t *job)
+{
+    if (job->slot < 0)
+        return;
+
+    if (job->rs) {
+        memset(dir_entry(job->slot), 0, DIR_ENTRY_LEN);
+        dir_release(job->slot);
+    } else {
+        dir_entry(job->slot)->size = job->size | FS_SIZE_RECORDED;
+        dir_entry(job->slot)->crc = job->crc;
+    }
+
+    cluster_lock(F_UNLCK, job->slot, 1);
+    job->slot = -1;
+}
+
+/* Read 'size' bytes from stdin and throw them away. Return 0, or 1 if the
+   stream ends before. */
+
+int tar_skip(size_t size)
+{
+    char block[TAR_BLOCK];
+    size_t n;
+
+    while (size > 0) {
+        n = fread(block, 1, size < TAR_BLOCK ? size : TAR_BLOCK, stdin);
+        if (!n)
+            return 1;
+        size -= n;
+    }
+
+    return 0;
+}
+
+/* Delete a file in the volume.
+ * Arguments: <file-name>
+ */
+
+int f_delete(int argc, const char **argv)
+{
+    int i;
+
+    /* Check preconditions. */
+
+    if (!volume_is_open() || !volume_is_fs_header())
+        return 1;
+
+    if (!arg_count(argc, 2, "Usage: delete <file-name>"))
+        return 1;
+
+    /* Search for the file name (and wait for whoever is using it). */
+
+    i = dir_find(argv[1], F_WRLCK);
+
+    if (i < 0) {
+        dir_unlock();
+        fprintf(stderr, "File '%s' not found in the volume\n", argv[1]);
+        return 1;
+    }
 
     /* Zero the entry (data region is not touched). */
 
-    for (i = 0; i < DIR_ENTRY_LEN; i++)
-        fputc(0, volume_fp);
+    memset(dir_entry(i), 0, DIR_ENTRY_LEN);
+    dir_release(i);
+    dir_unlock();
 
     return 0;
 }
@@ -545,14 +1509,16 @@ int f_delete(int argc, const char **argv)
 int f_hlist(int argc, const char **argv)
 {
     int pid, status, rs;
+    fflush(stdout);
     pid = fork();
     sysfatal(pid < 0);
     if (pid > 0)
         wait(&status);
     else {
         rs = execvp("ls", (char *const *)argv);
-        sysfatal(!rs);
+        sysfatal(rs < 0);
     }
+    return !WIFEXITED(status) || WEXITSTATUS(status);
 }
 
 /* All the user commands. */
@@ -568,18 +1534,33 @@ struct cmd_t cmds[] = {{f_help, "help"},
                        {f_put, "put"},
                        {f_get, "get"},
                        {f_delete, "delete"},
+                       {f_verify, "verify"},
+                       {f_sync, "sync"},
+                       {f_export, "export"},
+                       {f_import, "import"},
                        {f_hlist, "hlist"},
                        {0, 0}};
 
 /* Read an integer from stdin (alternative to scanf)*/
 
-int readint(FILE *fp)
+/* Parse 'str' (a decimal number, blanks around it allowed) times 'scale'
+   into 'val', a 16-bit header field. Return 1 on success; 0 if 'str' is
+   not a number or the result doesn't fit the field. */
+
+int parse_count(const char *str, unsigned scale, unsigned short *val)
 {
-    int val;
-    char buffer[CMD_LINE_LEN];
-    fgets(buffer, CMD_LINE_LEN - 1, fp);
-    val = atoi(buffer);
-    return val;
+    char *end;
+    unsigned long n;
+
+    str += strspn(str, " \t");
+    if (*str < '0' || *str > '9')
+        return 0;
+    n = strtoul(str, &end, 10);
+    end += strspn(end, " \t\n");
+    if (*end || n > USHRT_MAX / scale)
+        return 0;
+    *val = n * scale;
+    return 1;
 }
 
 /* If a volume is currently open, return 1;
@@ -587,8 +1568,8 @@ int readint(FILE *fp)
 
 int volume_is_open()
 {
-    if (!volume_fp) {
-        printf("No open volume\n");
+    if (!volume) {
+        fprintf(stderr, "No open volume\n");
         return 0;
     }
     return 1;
@@ -599,8 +1580,17 @@ int volume_is_open()
 
 int volume_is_fs_header()
 {
-    if (memcmp(fs_header.signature, FS_SIGNATURE, FS_SIGLEN)) {
-        printf("Fs_Header signature not found in the volume\n");
+    if (volume_locked == F_UNLCK) {
+        volume_lock(F_RDLCK, 0, sizeof(struct fs_header_t), 1);
+        volume_locked = F_RDLCK;
+    }
+
+    switch (tyfs_check(fs_header, volume_size / 512 > UINT_MAX ? UINT_MAX : volume_size / 512)) {
+    case TYFS_ERR_SIGNATURE:
+        fprintf(stderr, "Fs_Header signature not found in the volume\n");
+        return 0;
+    case TYFS_ERR_LAYOUT:
+        fprintf(stderr, "Fs_Header describes more than the volume holds\n");
         return 0;
     }
     return 1;
@@ -612,8 +1602,415 @@ int volume_is_fs_header()
 int arg_count(int argc, int number, const char *msg)
 {
     if (argc < number) {
-        printf("%s\n", msg);
+        fprintf(stderr, "%s\n", msg);
         return 0;
     }
     return 1;
 }
+
+/* Write the mapped volume back to the file, unmap and close it. Reset the
+   volume name and header info. */
+
+void volume_unmap(void)
+{
+    if (!volume)
+        return;
+
+    msync(volume, volume_size, MS_SYNC);
+    munmap(volume, volume_size);
+    close(volume_fd);
+
+    volume_fd = -1;
+    volume = NULL;
+    volume_size = 0;
+    volume_locked = F_UNLCK;
+    fs_header = &no_header;
+    dir_unload();
+
+    free(volume_name);
+    volume_name = NULL;
+}
+
+/* The directory region and the clusters, in the mapped volume (the
+   layout is libtyfs', see tyfs.h). */
+
+struct fs_entry_t *dir_entry(int i)
+{
+    return tyfs_entry((char *)volume + tyfs_dir_offset(fs_header), i);
+}
+
+unsigned char *file_data(int i) { return volume + tyfs_slot_offset(fs_header, i); }
+
+/* The bytes to copy out of the i-th file: its size, if recorded, or else
+   (an entry that predates sizes) its whole cluster. */
+
+unsigned int file_length(int i)
+{
+    int size = tyfs_entry_size(fs_header, dir_entry(i));
+
+    return size < 0 ? tyfs_file_size(fs_header) : (unsigned int)size;
+}
+
+/* Index the directory (see 'dir'). Buckets are at least twice as many as
+   entries, so that chains are short. */
+
+unsigned int dir_hash(const char *name)
+{
+    unsigned int i, hash = 2166136261u; /* FNV-1a. */
+
+    for (i = 0; i < FS_NAME_LEN && name[i]; i++)
+        hash = (hash ^ (unsigned char)name[i]) * 16777619u;
+
+    return hash & (dir.size - 1);
+}
+
+void dir_load(void)
+{
+    int i, entries = fs_header->number_of_file_entries;
+    unsigned int hash;
+
+    for (dir.size = 16; dir.size < 2 * (unsigned int)entries; dir.size *= 2)
+        ;
+
+    dir.bucket = malloc(dir.size * sizeof(*dir.bucket));
+    dir.next = malloc(entries * sizeof(*dir.next) + 1);
+    dir.name = malloc(entries * sizeof(*dir.name) + 1);
+    dir.free = malloc(entries * sizeof(*dir.free) + 1);
+    sysfatal(!dir.bucket || !dir.next || !dir.name || !dir.free);
+
+    memcpy(&dir.header, fs_header, sizeof(dir.header));
+    dir.stamp = dir_stamp() ? *dir_stamp() : 0;
+
+    memset(dir.bucket, -1, dir.size * sizeof(*dir.bucket));
+    dir.free_count = 0;
+
+    for (i = entries - 1; i >= 0; i--) {
+        if (!dir_entry(i)->name[0]) {
+            dir.free[dir.free_count++] = i;
+            continue;
+        }
+        memcpy(dir.name[i], dir_entry(i)->name, FS_NAME_LEN);
+        hash = dir_hash(dir.name[i]);
+        dir.next[i] = dir.bucket[hash];
+        dir.bucket[hash] = i;
+    }
+}
+
+void dir_unload(void)
+{
+    free(dir.bucket);
+    free(dir.next);
+    free(dir.name);
+    free(dir.free);
+    memset(&dir, 0, sizeof(dir));
+}
+
+/* The stamp: 4 bytes right after the last cluster, where the header
+   leaves 'unused_space' bytes. NULL if they are fewer, or past the end
+   of the file. */
+
+unsigned int *dir_stamp(void)
+{
+    size_t offset = tyfs_slot_offset(fs_header, fs_header->number_of_file_entries);
+
+    if (fs_header->unused_space < sizeof(unsigned int) ||
+        offset + sizeof(unsigned int) > volume_size)
+        return NULL;
+
+    return (unsigned int *)(volume + offset);
+}
+
+int dir_lookup(const char *name)
+{
+    int i;
+
+    for (i = dir.bucket[dir_hash(name)]; i >= 0; i = dir.next[i])
+        if (!strncmp(dir.name[i], name, FS_NAME_LEN))
+            break;
+
+    return i;
+}
+
+int dir_alloc(const char *name)
+{
+    int i;
+    unsigned int hash;
+
+    if (!dir.free_count)
+        return -1;
+
+    i = dir.free[--dir.free_count];
+    strncpy(dir.name[i], name, FS_NAME_LEN);
+    hash = dir_hash(dir.name[i]);
+    dir.next[i] = dir.bucket[hash];
+    dir.bucket[hash] = i;
+
+    return i;
+}
+
+void dir_release(int slot)
+{
+    int *link = &dir.bucket[dir_hash(dir.name[slot])];
+
+    while (*link != slot)
+        link = &dir.next[*link];
+    *link = dir.next[slot];
+
+    dir.free[dir.free_count++] = slot;
+}
+
+/* Locks (see 'volume_locked'). A range of 0 bytes is the whole volume.
+   Return 0, or -1 if the lock is held by someone else and 'wait' is 0. */
+
+int volume_lock(int type, off_t start, off_t length, int wait)
+{
+    struct flock lock;
+    int rs;
+
+    memset(&lock, 0, sizeof(lock)); /* OFD locks need l_pid zero. */
+    lock.l_type = type;
+    lock.l_whence = SEEK_SET;
+    lock.l_start = start;
+    lock.l_len = length;
+
+    do
+        rs = fcntl(volume_fd, wait ? F_OFD_SETLKW : F_OFD_SETLK, &lock);
+    while (rs < 0 && errno == EINTR);
+
+    sysfatal(rs < 0 && errno != EAGAIN && errno != EACCES);
+
+    return rs;
+}
+
+void volume_lock_all(void)
+{
+    volume_lock(F_WRLCK, 0, 0, 1);
+    volume_locked = F_WRLCK;
+}
+
+void volume_unlock(void)
+{
+    if (volume_locked != F_UNLCK)
+        volume_lock(F_UNLCK, 0, 0, 1);
+    volume_locked = F_UNLCK;
+}
+
+/* Lock the directory, and index it again if it was changed by others
+   (see the stamp, above) since it was indexed. */
+
+void dir_lock(int type)
+{
+    size_t length = fs_header->number_of_file_entries * DIR_ENTRY_LEN;
+
+    if (volume_locked != F_WRLCK)
+        volume_lock(type, tyfs_dir_offset(fs_header), length, 1);
+
+    if (!dir.bucket || !dir_stamp() || *dir_stamp() != dir.stamp ||
+        memcmp(&dir.header, fs_header, sizeof(dir.header))) {
+        dir_unload();
+        dir_load();
+    }
+    dir.locked = type;
+}
+
+/* Unlock the directory. If it was locked for writing, count one in the
+   stamp: the index is up to date with this command's changes, and others
+   will see them. With the whole volume locked, it stays so. */
+
+void dir_unlock(void)
+{
+    size_t length = fs_header->number_of_file_entries * DIR_ENTRY_LEN;
+
+    if (dir.locked == F_WRLCK && dir_stamp())
+        dir.stamp = ++*dir_stamp();
+    dir.locked = F_UNLCK;
+
+    if (volume_locked != F_WRLCK)
+        volume_lock(F_UNLCK, tyfs_dir_offset(fs_header), length, 1);
+}
+
+int cluster_lock(int type, int slot, int wait)
+{
+    if (volume_locked == F_WRLCK)
+        return 0;
+
+    return volume_lock(type, tyfs_slot_offset(fs_header, slot), tyfs_file_size(fs_header), wait);
+}
+
+/* Reserve an entry for a new file 'name', with the directory locked for
+   writing: take a free entry, lock its cluster for writing, and write the
+   name. A free entry whose cluster is still being read (the file was just
+   deleted) is passed over, and given back afterwards. Return the entry,
+   or -1 if no entry is free. */
+
+int dir_reserve(const char *name)
+{
+    int i, n = 0, *busy;
+
+    busy = malloc(dir.free_count * sizeof(*busy) + 1);
+    sysfatal(!busy);
+
+    while ((i = dir_alloc(name)) >= 0 && cluster_lock(F_WRLCK, i, 0) < 0)
+        busy[n++] = i;
+
+    while (n-- > 0)
+        dir_release(busy[n]);
+    free(busy);
+
+    if (i >= 0) {
+        memset(dir_entry(i), 0, DIR_ENTRY_LEN);
+        memcpy(dir_entry(i)->name, dir.name[i], FS_NAME_LEN);
+    }
+
+    return i;
+}
+
+/* Look up file 'name', with the directory locked as 'type' (and left so),
+   and lock its cluster the same way. If someone else has the cluster, the
+   directory is let go while waiting for it, and the lookup is done again.
+   Return the entry, or -1 if not found. */
+
+int dir_find(const char *name, int type)
+{
+    int i;
+
+    while (1) {
+        dir_lock(type);
+        i = dir_lookup(name);
+        if (i < 0 || !cluster_lock(type, i, 0))
+            return i;
+        dir_unlock();
+        cluster_lock(type, i, 1);
+        cluster_lock(F_UNLCK, i, 1);
+    }
+}
+
+/* Lock the directory and the clusters of all the files for reading (and
+   leave them so), waiting for those being written as dir_find() does. */
+
+void dir_lock_files(void)
+{
+    int i;
+    char *directory;
+
+    while (1) {
+        dir_lock(F_RDLCK);
+        directory = (char *)dir_entry(0);
+        for (i = tyfs_next(fs_header, directory, -1); i >= 0; i = tyfs_next(fs_header, directory, i))
+            if (cluster_lock(F_RDLCK, i, 0) < 0)
+                break;
+        if (i < 0)
+            return;
+        dir_unlock();
+        volume_lock(F_UNLCK, tyfs_slot_offset(fs_header, 0), 0, 1);
+        cluster_lock(F_RDLCK, i, 1);
+        cluster_lock(F_UNLCK, i, 1);
+    }
+}
+
+/* Run 'func' for every job, with as many threads as there are processors
+   (but no more than jobs). Each thread takes the next job not yet taken. */
+
+int (*job_func)(struct job_t *);
+int next_job;
+
+void *job_worker(void *arg)
+{
+    int k;
+
+    while ((k = __atomic_fetch_add(&next_job, 1, __ATOMIC_RELAXED)) < job_count)
+        jobs[k].rs = job_func(&jobs[k]);
+
+    return NULL;
+}
+
+void run_jobs(int (*func)(struct job_t *))
+{
+    int i, threads;
+    pthread_t *tid;
+
+    job_func = func;
+    next_job = 0;
+
+    threads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads > job_count)
+        threads = job_count;
+    if (threads <= 1) {
+        job_worker(NULL);
+        return;
+    }
+
+    tid = malloc(threads * sizeof(*tid));
+    sysfatal(!tid);
+
+    for (i = 0; i < threads; i++)
+        sysfatal(pthread_create(&tid[i], NULL, job_worker, NULL));
+    for (i = 0; i < threads; i++)
+        pthread_join(tid[i], NULL);
+
+    free(tid);
+}
+
+void add_job(const char *path)
+{
+    jobs = realloc(jobs, (job_count + 1) * sizeof(*jobs));
+    sysfatal(!jobs);
+    memset(&jobs[job_count], 0, sizeof(*jobs));
+    jobs[job_count++].path = strdup(path);
+}
+
+void free_jobs(void)
+{
+    int k;
+
+    for (k = 0; k < job_count; k++)
+        free(jobs[k].path);
+    free(jobs);
+    jobs = NULL;
+    job_count = 0;
+}
+
+/* CRC-32 (the polynomial of Ethernet, zlib and PNG), computed 8 bytes at a
+   time with 8 tables ("slicing-by-8"): table[0] is the usual byte-wise one,
+   and table[k] advances the CRC of a byte followed by k zeros. */
+
+uint32_t crc_table[8][256];
+
+void crc32_init(void)
+{
+    int i, j;
+    uint32_t crc;
+
+    for (i = 0; i < 256; i++) {
+        crc = i;
+        for (j = 0; j < 8; j++)
+            crc = crc & 1 ? (crc >> 1) ^ 0xedb88320 : crc >> 1;
+        crc_table[0][i] = crc;
+    }
+
+    for (i = 0; i < 256; i++)
+        for (j = 1; j < 8; j++)
+            crc_table[j][i] = (crc_table[j - 1][i] >> 8) ^ crc_table[0][crc_table[j - 1][i] & 0xff];
+}
+
+unsigned int crc32(const unsigned char *data, size_t size)
+{
+    uint32_t crc = 0xffffffff, one, two;
+
+    for (; size && ((uintptr_t)data & 7); size--)
+        crc = (crc >> 8) ^ crc_table[0][(crc ^ *data++) & 0xff];
+
+    for (; size >= 8; size -= 8, data += 8) {
+        one = *(const uint32_t *)data ^ crc; /* Little endian. */
+        two = *(const uint32_t *)(data + 4);
+        crc = crc_table[7][one & 0xff] ^ crc_table[6][(one >> 8) & 0xff] ^
+              crc_table[5][(one >> 16) & 0xff] ^ crc_table[4][one >> 24] ^
+              crc_table[3][two & 0xff] ^ crc_table[2][(two >> 8) & 0xff] ^
+              crc_table[1][(two >> 16) & 0xff] ^ crc_table[0][two >> 24];
+    }
+
+    for (; size; size--)
+        crc = (crc >> 8) ^ crc_table[0][(crc ^ *data++) & 0xff];
+
+    return ~crc;
+}
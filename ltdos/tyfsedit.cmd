@@ -0,0 +1,3 @@
+open disk.img
+sync hello.bin prog.bin echo.bin sysloop.bin sysbench.bin conbench.bin readbench.bin dirbench.bin sonnets/sonnet_18.txt sonnets/sonnet_29.txt sonnets/sonnet_116.txt sonnets/sonnet_130.txt
+quit
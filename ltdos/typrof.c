@@ -0,0 +1,228 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+/* typrof - attribute a TyDOS profile to the program's functions.
+
+   Usage: typrof [-n count] <program.map | program.elf> [dump]
+
+   The dump is the text the kernel writes to the serial port on 'prof dump'
+   (see prof.h), e.g. the log of 'qemu -serial file:prof.log'; any other
+   text around it is ignored. Symbols come either from the program's link
+   map (made by 'ld -Map', which only lists global symbols) or from its ELF
+   file (program.elf, which has the static functions too). Each bucket is
+   attributed to the symbol at or right before its start, so a function
+   shorter than a bucket may take some of its neighbour's samples. The
+   'count' functions with the most samples are printed (default 20).
+   This is a host program: it runs on the build machine, not on TyDOS. */
+
+#include <ctype.h>
+#include <elf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "prof.h"
+
+#define MAX_SYMBOLS 4096
+
+struct symbol_t {
+    unsigned int addr;
+    char name[64];
+    unsigned int samples;
+} symbols[MAX_SYMBOLS];
+int n_symbols;
+
+void fatal(const char *msg, const char *arg)
+{
+    fprintf(stderr, "typrof: %s%s%s\n", msg, arg ? ": " : "", arg ? arg : "");
+    exit(EXIT_FAILURE);
+}
+
+void add_symbol(unsigned int addr, const char *name)
+{
+    if (n_symbols == MAX_SYMBOLS)
+        fatal("too many symbols", NULL);
+    symbols[n_symbols].addr = addr;
+    snprintf(symbols[n_symbols].name, sizeof(symbols[0].name), "%s", name);
+    n_symbols++;
+}
+
+/* Read the function and object symbols of an ELF file. */
+
+void read_elf(FILE *fp)
+{
+    long size;
+    unsigned char *elf;
+    Elf32_Ehdr *ehdr;
+    Elf32_Shdr *shdr;
+    Elf32_Sym *sym;
+    int i, j, n, type;
+
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    elf = malloc(size);
+    if (!elf || fread(elf, 1, size, fp) != (size_t)size)
+        fatal("can't read the ELF file", NULL);
+
+    ehdr = (Elf32_Ehdr *)elf;
+    if (ehdr->e_ident[EI_CLASS] != ELFCLASS32)
+        fatal("not a 32-bit ELF file", NULL);
+    shdr = (Elf32_Shdr *)(elf + ehdr->e_shoff);
+
+    for (i = 0; i < ehdr->e_shnum; i++) {
+        if (shdr[i].sh_type != SHT_SYMTAB)
+            continue;
+        sym = (Elf32_Sym *)(elf + shdr[i].sh_offset);
+        n = shdr[i].sh_size / sizeof(Elf32_Sym);
+        for (j = 0; j < n; j++) {
+            type = ELF32_ST_TYPE(sym[j].st_info);
+            if (sym[j].st_shndx == SHN_UNDEF || sym[j].st_shndx >= SHN_LORESERVE || !sym[j].st_name)
+                continue;
+            if (type != STT_FUNC && type != STT_OBJECT && type != STT_NOTYPE)
+                continue;
+            add_symbol(sym[j].st_value,
+                       (char *)elf + shdr[shdr[i].sh_link].sh_offset + sym[j].st_name);
+        }
+    }
+    free(elf);
+}
+
+/* Read the symbols of a link map: lines with just an address and a name. */
+
+void read_map(FILE *fp)
+{
+    char line[256], name[256], extra[2];
+    unsigned long long addr;
+
+    while (fgets(line, sizeof(line), fp))
+        if (sscanf(line, " 0x%llx %255s %1s", &addr, name, extra) == 2 &&
+            (isalpha((unsigned char)name[0]) || name[0] == '_'))
+            add_symbol(addr, name);
+}
+
+int by_addr(const void *a, const void *b)
+{
+    const struct symbol_t *x = a, *y = b;
+    return x->addr < y->addr ? -1 : x->addr > y->addr;
+}
+
+int by_samples(const void *a, const void *b)
+{
+    const struct symbol_t *x = a, *y = b;
+    return x->samples > y->samples ? -1 : x->samples < y->samples;
+}
+
+/* Return the symbol at or right before 'addr', or NULL. */
+
+struct symbol_t *lookup(unsigned int addr)
+{
+    int lo = 0, hi = n_symbols - 1, mid;
+    struct symbol_t *found = NULL;
+
+    while (lo <= hi) {
+        mid = (lo + hi) / 2;
+        if (symbols[mid].addr <= addr) {
+            found = &symbols[mid];
+            lo = mid + 1;
+        } else
+            hi = mid - 1;
+    }
+    return found;
+}
+
+int main(int argc, char **argv)
+{
+    int opt, i, in_dump = 0, count = 20;
+    char line[256], name[64], *p;
+    unsigned int samples = 0, program = 0, kernel = 0, bios = 0, grain = 0, offset, n;
+    unsigned int unknown = 0;
+    unsigned char magic[SELFMAG];
+    struct symbol_t *sym;
+    FILE *fp, *dump = stdin;
+
+    while ((opt = getopt(argc, argv, "n:")) != -1) {
+        switch (opt) {
+        case 'n':
+            count = atoi(optarg);
+            break;
+        default:
+            fatal("usage: typrof [-n count] <program.map | program.elf> [dump]", NULL);
+        }
+    }
+    if (argc - optind < 1 || argc - optind > 2)
+        fatal("usage: typrof [-n count] <program.map | program.elf> [dump]", NULL);
+
+    /* Load the symbols, sorted by address. */
+
+    fp = fopen(argv[optind], "r");
+    if (!fp)
+        fatal("can't open", argv[optind]);
+    if (fread(magic, 1, SELFMAG, fp) == SELFMAG && !memcmp(magic, ELFMAG, SELFMAG))
+        read_elf(fp);
+    else {
+        rewind(fp);
+        read_map(fp);
+    }
+    fclose(fp);
+    qsort(symbols, n_symbols, sizeof(symbols[0]), by_addr);
+
+    if (argc - optind == 2 && !(dump = fopen(argv[optind + 1], "r")))
+        fatal("can't open", argv[optind + 1]);
+
+    /* Attribute the samples of each bucket in the dump. */
+
+    while (fgets(line, sizeof(line), dump)) {
+        if (!in_dump) {
+            p = strstr(line, "TyPF ");
+            if (p && sscanf(p, "TyPF %63s %x %x %x %x %x", name, &samples, &program, &kernel,
+                            &bios, &grain) == 6)
+                in_dump = 1;
+            continue;
+        }
+        if (!strncmp(line, "end", 3))
+            break;
+        if (sscanf(line, "%x %x", &offset, &n) != 2)
+            fatal("bad line in dump", line);
+        sym = lookup(offset);
+        if (sym)
+            sym->samples += n;
+        else
+            unknown += n;
+    }
+    if (!in_dump)
+        fatal("no profile (TyPF) in the dump", NULL);
+    if (grain != PROF_GRAIN)
+        fprintf(stderr, "typrof: warning: dump has %u-byte buckets, expected %u\n", grain,
+                PROF_GRAIN);
+
+    printf("%s: %u samples: %u in the program, %u in the kernel, %u in the BIOS\n\n", name,
+           samples, program, kernel, bios);
+    if (!samples)
+        return EXIT_SUCCESS;
+
+    qsort(symbols, n_symbols, sizeof(symbols[0]), by_samples);
+    printf("%8s %6s  %s\n", "samples", "%", "function");
+    for (i = 0; i < n_symbols && i < count && symbols[i].samples; i++)
+        printf("%8u %6.1f  %s\n", symbols[i].samples, 100.0 * symbols[i].samples / samples,
+               symbols[i].name);
+    if (unknown)
+        printf("%8u %6.1f  %s\n", unknown, 100.0 * unknown / samples, "(unknown)");
+    if (kernel)
+        printf("%8u %6.1f  %s\n", kernel, 100.0 * kernel / samples, "(kernel)");
+    if (bios)
+        printf("%8u %6.1f  %s\n", bios, 100.0 * bios / samples, "(BIOS)");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,132 @@
+/*
+ *    SPDX-FileCopyrightText: 2024 Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Tiago Oliva <tiago.oliva.costa@gmail.com>
+ *    SPDX-FileCopyrightText: 2024 Monaco F. J. <monaco@usp.br>
+ *
+ *    SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *  This file is a derivative work from SYSeg (https://gitlab.com/monaco/syseg)
+ *  and contains modifications carried out by the following author(s):
+ *  Luiz Antonio de Abreu Pereira <lap.junior@gmail.com>
+ *  Tiago Oliva <tiago.oliva.costa@gmail.com>
+ */
+
+/* tytrace - turn a TyDOS trace dump into a timeline.
+
+   Usage: tytrace [-f MHz] [file]
+
+   The input is the text the kernel writes to the serial port on 'trace
+   dump' (see trace.h), e.g. the log of 'qemu -serial file:trace.log'; any
+   other text around the dump is ignored. Each event is printed with its
+   time since the first event and since the previous one, in cycles or, if
+   the CPU clock is given with -f, in microseconds. Events that end an
+   operation (sysret, disk done...) also show how long the operation took.
+   This is a host program: it runs on the build machine, not on TyDOS. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "trace.h"
+
+const char *names[TRACE_TYPES] = TRACE_NAMES;
+
+/* The event that starts the operation ended by each event type, if any. */
+
+const int starts[TRACE_TYPES] = {[TRACE_SYSRET] = TRACE_SYSCALL,
+                                 [TRACE_DISK_DONE] = TRACE_DISK,
+                                 [TRACE_LOAD_DONE] = TRACE_LOAD,
+                                 [TRACE_KBD_DONE] = TRACE_KBD_WAIT};
+
+double mhz; /* CPU clock, or 0 to show cycles. */
+
+void fatal(const char *msg, const char *arg)
+{
+    fprintf(stderr, "tytrace: %s%s%s\n", msg, arg ? ": " : "", arg ? arg : "");
+    exit(EXIT_FAILURE);
+}
+
+/* Print a number of cycles, converted to microseconds if we can. */
+
+void print_time(unsigned long long cycles)
+{
+    if (mhz)
+        printf(" %12.1f", cycles / mhz);
+    else
+        printf(" %12llu", cycles);
+}
+
+/* Parse one dumped event: 32 hex digits. Return 0 on success. */
+
+int parse_event(const char *line, struct trace_event_t *event)
+{
+    unsigned char *p = (unsigned char *)event;
+    unsigned int byte, i;
+
+    for (i = 0; i < sizeof(*event); i++) {
+        if (sscanf(line + 2 * i, "%2x", &byte) != 1)
+            return -1;
+        p[i] = byte;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int opt, in_dump = 0, i;
+    char line[256];
+    unsigned long long first = 0, prev = 0, start[TRACE_TYPES] = {0};
+    struct trace_event_t event;
+    FILE *fp = stdin;
+
+    while ((opt = getopt(argc, argv, "f:")) != -1) {
+        switch (opt) {
+        case 'f':
+            mhz = strtod(optarg, NULL);
+            break;
+        default:
+            fatal("usage: tytrace [-f MHz] [file]", NULL);
+        }
+    }
+    if (optind < argc && !(fp = fopen(argv[optind], "r")))
+        fatal("can't open", argv[optind]);
+
+    printf("%13s %12s %-10s %5s %10s %6s %12s\n", mhz ? "time (us)" : "time (cyc)",
+           "delta", "event", "arg", "value", "status", "took");
+
+    while (fgets(line, sizeof(line), fp)) {
+        if (!in_dump) {
+            if (strstr(line, "TyTR"))
+                in_dump = 1, prev = 0;
+            continue;
+        }
+        if (!strncmp(line, "end", 3)) {
+            in_dump = 0;
+            continue;
+        }
+        if (parse_event(line, &event))
+            fatal("bad event in dump", line);
+        if (event.type == TRACE_NONE)
+            continue;
+
+        if (!first)
+            first = event.tsc;
+        print_time(event.tsc - first);
+        print_time(prev ? event.tsc - prev : 0);
+        prev = event.tsc;
+
+        printf(" %-10s %5u %10u %6u", event.type < TRACE_TYPES ? names[event.type] : "?",
+               event.arg, event.value, event.status);
+
+        if (event.type < TRACE_TYPES) {
+            start[event.type] = event.tsc;
+            i = starts[event.type];
+            if (i && start[i])
+                print_time(event.tsc - start[i]);
+        }
+        printf("\n");
+    }
+
+    return EXIT_SUCCESS;
+}